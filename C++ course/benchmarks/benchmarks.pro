@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    cards_bench \
+    cracker_bench \
+    encryption_bench \
+    molkky_bench \
+    pairs_bench
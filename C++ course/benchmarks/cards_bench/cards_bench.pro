@@ -0,0 +1,20 @@
+TEMPLATE = app
+CONFIG += console c++11 thread release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../cards
+
+SOURCES += main.cpp \
+    heap_cards.cpp \
+    ../harness/bench.cpp \
+    ../../cards/cards.cpp \
+    ../../cards/concurrent_cards.cpp \
+    ../../cards/list_storage.cpp \
+    ../../cards/mapped_file.cpp \
+    ../../cards/ring_storage.cpp \
+    ../../cards/shuffle.cpp
+
+HEADERS += \
+    heap_cards.hh \
+    ../harness/bench.hh
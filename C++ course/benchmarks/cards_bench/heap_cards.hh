@@ -0,0 +1,55 @@
+#ifndef HEAP_CARDS_HH
+#define HEAP_CARDS_HH
+
+#include <iostream>
+
+// The deck as it was before the storage policies: one heap allocation per
+// card in a singly linked list, with rotations walking the whole deck.
+// Kept only as the baseline of the deck benchmarks.
+class Heap_cards {
+
+    public:
+      // A dynamic structure must have a constructor
+      // that initializes the top item as nullptr.
+      Heap_cards();
+
+      // Adds a new card with the given id as the topmost element.
+      void add(int id);
+
+      // Prints the content of the data structure with ordinal numbers to the
+      // output stream given as a parameter starting from the first element.
+      void print_from_top_to_bottom(std::ostream& s);
+
+      // Removes the topmost card and passes it in the reference parameter id to the caller.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool remove(int& id);
+
+      // Moves the last element of the data structure as the first one.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool bottom_to_top();
+
+      // Moves the first element of the data structure as the last one.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool top_to_bottom();
+
+      // Prints the content of the data structure with ordinal numbers to the
+      // output stream given as a parameter starting from the last element.
+      void print_from_bottom_to_top(std::ostream& s);
+
+      // A dynamic data structure must have a destructor
+      // that can be called to deallocate memory,
+      // when the data structure is not needed any more.
+      ~Heap_cards();
+
+    private:
+      struct Card_data {
+        int data;
+        Card_data* next;
+      };
+
+      Card_data* top_;
+
+      int recursive_print(Card_data* top, std::ostream& s);
+};
+
+#endif // HEAP_CARDS_HH
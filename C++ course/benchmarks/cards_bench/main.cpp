@@ -0,0 +1,438 @@
+/* Cards benchmarks
+ *
+ * Benchmarks of the deck of the cards program: adding and removing cards,
+ * rotations, traversal and printing, the bulk operations, the concurrent
+ * deck, shuffling and snapshots. Heap_cards, the deck with one heap
+ * allocation per card, is the baseline for the single-card operations.
+ *
+ * On Linux the peak RSS of the final run of each benchmark is reported as
+ * peak_rss_kb. It starts from what the process already holds, including
+ * memory the allocator kept from earlier benchmarks. Elsewhere only the
+ * peak of the whole process so far is known, reported as
+ * process_peak_rss_kb, so run one benchmark alone with --filter to see its
+ * memory use.
+ */
+
+#include "bench.hh"
+#include "cards.hh"
+#include "concurrent_cards.hh"
+#include "heap_cards.hh"
+#include <cstdio>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Stream buffer that throws away everything written to it.
+class Null_buffer : public streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+
+    streamsize xsputn(const char*, streamsize n) override
+    {
+        return n;
+    }
+};
+
+// Cards guarded by one mutex, the baseline of the concurrent deck.
+class Locked_cards
+{
+public:
+    void add(int id)
+    {
+        lock_guard<mutex> lock(mutex_);
+        cards_.add(id);
+    }
+
+    bool remove(int& id)
+    {
+        lock_guard<mutex> lock(mutex_);
+        return cards_.remove(id);
+    }
+
+private:
+    mutex mutex_;
+    Cards cards_;
+};
+
+template <typename Deck>
+void fill(Deck& deck, int n)
+{
+    for(int i = 0; i < n; ++i)
+    {
+        deck.add(i);
+    }
+}
+
+template <typename Deck>
+void bench_push_pop(Bench_runner& runner, const string& backend, int n)
+{
+    runner.run("cards/push_pop/" + backend + "/" + to_string(n), [n](Bench_state& state) {
+        Deck deck;
+        int id = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            fill(deck, n);
+            while(deck.remove(id))
+            {
+            }
+        }
+        do_not_optimize(id);
+        state.set_items_processed(2.0 * n * state.iterations());
+    });
+
+    runner.run("cards/fill_destroy/" + backend + "/" + to_string(n), [n](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Deck deck;
+            fill(deck, n);
+        }
+        state.set_items_processed(1.0 * n * state.iterations());
+    });
+}
+
+template <typename Deck>
+void bench_rotate(Bench_runner& runner, const string& backend, int n)
+{
+    runner.run("cards/rotate_one/" + backend + "/" + to_string(n), [n](Bench_state& state) {
+        state.pause_timing();
+        Deck deck;
+        fill(deck, n);
+        state.resume_timing();
+
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            deck.bottom_to_top();
+            deck.top_to_bottom();
+        }
+        state.set_items_processed(2.0 * state.iterations());
+
+        state.pause_timing();
+    });
+}
+
+template <typename Deck>
+void bench_traverse(Bench_runner& runner, const string& backend, int n)
+{
+    runner.run("cards/traverse/" + backend + "/" + to_string(n), [n](Bench_state& state) {
+        state.pause_timing();
+        Deck deck;
+        fill(deck, n);
+        deck.shuffle(1);
+        state.resume_timing();
+
+        long long sum = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(int id : deck)
+            {
+                sum += id;
+            }
+        }
+        do_not_optimize(sum);
+        state.set_items_processed(1.0 * n * state.iterations());
+
+        state.pause_timing();
+    });
+}
+
+template <typename Deck>
+void bench_print(Bench_runner& runner, const string& backend, int n)
+{
+    runner.run("cards/print/" + backend + "/" + to_string(n), [n](Bench_state& state) {
+        state.pause_timing();
+        Deck deck;
+        fill(deck, n);
+        Null_buffer buffer;
+        ostream out(&buffer);
+        state.resume_timing();
+
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            deck.print_from_top_to_bottom(out);
+            deck.print_from_bottom_to_top(out);
+        }
+        state.set_items_processed(2.0 * n * state.iterations());
+
+        state.pause_timing();
+    });
+}
+
+template <typename Deck>
+void bench_bulk(Bench_runner& runner, const string& backend, int n)
+{
+    const string suffix = "/" + backend + "/" + to_string(n);
+    vector<int> ids(n);
+    for(int i = 0; i < n; ++i)
+    {
+        ids.at(i) = i;
+    }
+
+    runner.run("cards/add_loop" + suffix, [n, &ids](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Deck deck;
+            for(int id : ids)
+            {
+                deck.add(id);
+            }
+        }
+        state.set_items_processed(1.0 * n * state.iterations());
+    });
+
+    runner.run("cards/add_range" + suffix, [n, &ids](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Deck deck;
+            deck.add_range(ids.data(), ids.data() + ids.size());
+        }
+        state.set_items_processed(1.0 * n * state.iterations());
+    });
+
+    runner.run("cards/remove_loop" + suffix, [n, &ids](Bench_state& state) {
+        vector<int> out(n);
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            state.pause_timing();
+            Deck deck;
+            deck.add_range(ids.data(), ids.data() + ids.size());
+            state.resume_timing();
+
+            for(int& id : out)
+            {
+                deck.remove(id);
+            }
+        }
+        do_not_optimize(out.front());
+        state.set_items_processed(1.0 * n * state.iterations());
+    });
+
+    runner.run("cards/remove_n" + suffix, [n, &ids](Bench_state& state) {
+        vector<int> out(n);
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            state.pause_timing();
+            Deck deck;
+            deck.add_range(ids.data(), ids.data() + ids.size());
+            state.resume_timing();
+
+            deck.remove_n(out.size(), out.data());
+        }
+        do_not_optimize(out.front());
+        state.set_items_processed(1.0 * n * state.iterations());
+    });
+
+    // Rotating by a third of the deck, card by card and in one call.
+    const int k = n / 3;
+    runner.run("cards/bottom_to_top_loop" + suffix, [k, &ids](Bench_state& state) {
+        state.pause_timing();
+        Deck deck;
+        deck.add_range(ids.data(), ids.data() + ids.size());
+        state.resume_timing();
+
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(int j = 0; j < k; ++j)
+            {
+                deck.bottom_to_top();
+            }
+        }
+        state.set_items_processed(1.0 * k * state.iterations());
+
+        state.pause_timing();
+    });
+
+    runner.run("cards/rotate_k" + suffix, [k, &ids](Bench_state& state) {
+        state.pause_timing();
+        Deck deck;
+        deck.add_range(ids.data(), ids.data() + ids.size());
+        state.resume_timing();
+
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            deck.rotate(-k);
+        }
+        state.set_items_processed(1.0 * k * state.iterations());
+
+        state.pause_timing();
+    });
+
+    runner.run("cards/splice" + suffix, [n, &ids](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            state.pause_timing();
+            Deck deck;
+            Deck other;
+            deck.add_range(ids.data(), ids.data() + ids.size());
+            other.add_range(ids.data(), ids.data() + ids.size());
+            state.resume_timing();
+
+            deck.splice(other);
+
+            state.pause_timing();
+        }
+        state.resume_timing();
+        state.set_items_processed(1.0 * n * state.iterations());
+    });
+}
+
+template <typename Deck>
+void bench_concurrent(Bench_runner& runner, const string& name, unsigned int threads)
+{
+    const int OPERATIONS = 100000;
+
+    runner.run("cards/concurrent/" + name + "/threads:" + to_string(threads),
+               [threads, OPERATIONS](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Deck deck;
+            vector<thread> workers;
+            for(unsigned int t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&deck, OPERATIONS]() {
+                    int id = 0;
+                    for(int j = 0; j < OPERATIONS; ++j)
+                    {
+                        deck.add(j);
+                        deck.add(j);
+                        deck.remove(id);
+                    }
+                    while(deck.remove(id))
+                    {
+                    }
+                });
+            }
+            for(thread& worker : workers)
+            {
+                worker.join();
+            }
+        }
+        state.set_items_processed(3.0 * OPERATIONS * threads * state.iterations());
+    });
+}
+
+template <typename Deck>
+void bench_shuffle(Bench_runner& runner, const string& backend, int n)
+{
+    runner.run("cards/shuffle/" + backend + "/" + to_string(n), [n](Bench_state& state) {
+        state.pause_timing();
+        Deck deck;
+        fill(deck, n);
+        state.resume_timing();
+
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            deck.shuffle(i);
+        }
+        state.set_items_processed(1.0 * n * state.iterations());
+
+        state.pause_timing();
+    });
+}
+
+template <typename Deck>
+void bench_restore(Bench_runner& runner, const string& backend, int n)
+{
+    const string path = "cards_bench_snapshot.bin";
+
+    runner.run("cards/restore/add_loop/" + backend + "/" + to_string(n), [n](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Deck deck;
+            fill(deck, n);
+        }
+        state.set_items_processed(1.0 * n * state.iterations());
+    });
+
+    runner.run("cards/restore/load/" + backend + "/" + to_string(n), [n, &path](Bench_state& state) {
+        state.pause_timing();
+        {
+            Deck saved;
+            fill(saved, n);
+            saved.save(path);
+        }
+        state.resume_timing();
+
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Deck deck;
+            deck.load(path);
+        }
+        state.set_items_processed(1.0 * n * state.iterations());
+
+        state.pause_timing();
+    });
+
+    remove(path.c_str());
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    Bench_runner runner(argc, argv);
+
+    // Node pool against one allocation per card
+    for(int n : {1000, 1000000})
+    {
+        bench_push_pop<Heap_cards>(runner, "heap", n);
+        bench_push_pop<Cards>(runner, "list", n);
+        bench_push_pop<Ring_cards>(runner, "ring", n);
+    }
+
+    // Rotation cost by deck size; the baseline walks the whole deck
+    for(int n : {10, 1000, 100000})
+    {
+        bench_rotate<Heap_cards>(runner, "heap", n);
+    }
+    for(int n : {10, 1000, 100000, 10000000})
+    {
+        bench_rotate<Cards>(runner, "list", n);
+        bench_rotate<Ring_cards>(runner, "ring", n);
+    }
+
+    // Storage layouts
+    for(int n : {1000, 1000000})
+    {
+        bench_traverse<Cards>(runner, "list", n);
+        bench_traverse<Ring_cards>(runner, "ring", n);
+    }
+    bench_print<Heap_cards>(runner, "heap", 100000);
+    bench_print<Cards>(runner, "list", 100000);
+    bench_print<Ring_cards>(runner, "ring", 100000);
+
+    // Bulk operations against loops of single-card calls
+    bench_bulk<Cards>(runner, "list", 1000000);
+    bench_bulk<Ring_cards>(runner, "ring", 1000000);
+
+    // Lock-free deck against a mutex around Cards
+    unsigned int max_threads = thread::hardware_concurrency();
+    for(unsigned int threads = 1; threads <= max_threads or threads <= 2; threads *= 2)
+    {
+        bench_concurrent<Concurrent_cards>(runner, "lock_free", threads);
+        bench_concurrent<Locked_cards>(runner, "mutex", threads);
+    }
+
+    // Sequential and parallel shuffles
+    for(int n : {100000, 1000000, 1 << 22, 1 << 24})
+    {
+        bench_shuffle<Ring_cards>(runner, "ring", n);
+    }
+    bench_shuffle<Cards>(runner, "list", 1000000);
+
+    // Startup: snapshot load against adding card by card
+    bench_restore<Cards>(runner, "list", 10000000);
+    bench_restore<Ring_cards>(runner, "ring", 10000000);
+
+    return runner.finish();
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+CONFIG += console c++11 thread release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../cracker
+
+SOURCES += main.cpp \
+    ../harness/bench.cpp \
+    ../../cracker/cracker.cpp \
+    ../../cracker/trigram_model.cpp
+
+HEADERS += \
+    ../harness/bench.hh
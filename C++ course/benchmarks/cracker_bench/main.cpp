@@ -0,0 +1,190 @@
+/* Cracker benchmarks
+ *
+ * Benchmarks of the key recovery tool on text from a synthetic language:
+ * scoring a key over the whole text against scoring a swap incrementally,
+ * and cracking texts of different lengths, with the keys tried per second
+ * and the share of texts that were decrypted.
+ */
+
+#include "bench.hh"
+#include "cracker.hh"
+#include "trigram_model.hh"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// letters the model is trained with
+const size_t CORPUS_LETTERS = 2000000;
+
+// texts cracked in each iteration of a crack benchmark
+const size_t TEXTS_PER_ITERATION = 4;
+
+// A text counts as decrypted when this share of its letters is right.
+const double DECRYPTED_SHARE = 0.9;
+
+// Order-2 Markov chain over the letters a-z with skewed transitions, which
+// stands in for a natural language corpus: its trigram statistics are as
+// uneven as those of English, with about 3 bits of entropy per letter.
+class Markov_source
+{
+public:
+    Markov_source(uint64_t seed):
+        cumulative_(26 * 26)
+    {
+        mt19937_64 rng(seed);
+        normal_distribution<double> normal(0, 1);
+        vector<double> letter_weight(26);
+        for(double& weight : letter_weight)
+        {
+            weight = exp(normal(rng));
+        }
+        for(array<double, 26>& context : cumulative_)
+        {
+            double total = 0;
+            for(int letter = 0; letter < 26; ++letter)
+            {
+                total += letter_weight.at(letter) * exp(1.5 * normal(rng));
+                context.at(letter) = total;
+            }
+            for(double& sum : context)
+            {
+                sum /= total;
+            }
+        }
+    }
+
+    string generate(size_t letters, uint64_t seed) const
+    {
+        mt19937_64 rng(seed);
+        uniform_real_distribution<double> chance(0, 1);
+        string text(letters, 'a');
+        int previous[2] = {0, 0};
+        for(char& c : text)
+        {
+            const array<double, 26>& context = cumulative_.at(previous[0] * 26 + previous[1]);
+            int letter = static_cast<int>(lower_bound(context.begin(), context.end() - 1,
+                                                      chance(rng)) - context.begin());
+            c = static_cast<char>('a' + letter);
+            previous[0] = previous[1];
+            previous[1] = letter;
+        }
+        return text;
+    }
+
+private:
+    // cumulative distribution of the next letter after each pair of letters
+    vector<array<double, 26>> cumulative_;
+};
+
+string random_key(mt19937_64& rng)
+{
+    string key = "abcdefghijklmnopqrstuvwxyz";
+    shuffle(key.begin(), key.end(), rng);
+    return key;
+}
+
+string encrypt_with(const string& text, const string& key)
+{
+    string encrypted = text;
+    for(char& c : encrypted)
+    {
+        c = key.at(c - 'a');
+    }
+    return encrypted;
+}
+
+void bench_scoring(Bench_runner& runner, const Markov_source& source, const Trigram_model& model)
+{
+    mt19937_64 rng(3);
+    const Cracker cracker(model, encrypt_with(source.generate(1000, 3), random_key(rng)));
+    Decryption decryption;
+    for(int i = 0; i < 26; ++i)
+    {
+        decryption.at(i) = i;
+    }
+
+    runner.run("cracker/score/letters:1000", [&](Bench_state& state) {
+        double total = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            swap(decryption.at(i % 26), decryption.at((i * 7 + 3) % 26));
+            total += cracker.score(decryption);
+        }
+        do_not_optimize(total);
+        state.set_items_processed(1.0 * state.iterations());
+    });
+
+    runner.run("cracker/swap_delta/letters:1000", [&](Bench_state& state) {
+        double total = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            total += cracker.swap_delta(decryption, i % 26, (i * 7 + 3) % 26);
+        }
+        do_not_optimize(total);
+        state.set_items_processed(1.0 * state.iterations());
+    });
+}
+
+void bench_crack(Bench_runner& runner, const Markov_source& source, const Trigram_model& model,
+                 size_t letters)
+{
+    runner.run("cracker/crack/letters:" + to_string(letters), [&, letters](Bench_state& state) {
+        Crack_options options;
+        options.threads = max(1u, thread::hardware_concurrency());
+        mt19937_64 rng(letters);
+        size_t decrypted = 0;
+        double keys_tried = 0;
+        for(size_t i = 0; i < state.iterations() * TEXTS_PER_ITERATION; ++i)
+        {
+            state.pause_timing();
+            const string text = source.generate(letters, rng());
+            const string key = random_key(rng);
+            const Cracker cracker(model, encrypt_with(text, key));
+            options.seed = rng();
+            state.resume_timing();
+
+            Crack_result result = cracker.crack(options);
+            keys_tried += result.keys_tried;
+
+            state.pause_timing();
+            size_t right = 0;
+            for(char c : text)
+            {
+                right += result.key.at(c - 'a') == key.at(c - 'a');
+            }
+            decrypted += right >= DECRYPTED_SHARE * letters;
+            state.resume_timing();
+        }
+        state.set_items_processed(keys_tried);
+        state.set_counter("success_rate",
+                          1.0 * decrypted / (state.iterations() * TEXTS_PER_ITERATION));
+    });
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    Bench_runner runner(argc, argv);
+
+    const Markov_source source(1);
+    Trigram_model model;
+    model.train(source.generate(CORPUS_LETTERS, 2));
+
+    bench_scoring(runner, source, model);
+    for(size_t letters : {50, 100, 200, 400, 1000})
+    {
+        bench_crack(runner, source, model, letters);
+    }
+
+    return runner.finish();
+}
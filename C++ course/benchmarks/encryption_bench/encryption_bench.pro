@@ -0,0 +1,18 @@
+TEMPLATE = app
+CONFIG += console c++14 thread release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../encryption
+
+SOURCES += main.cpp \
+    ../harness/bench.cpp \
+    ../../encryption/cipher.cpp \
+    ../../encryption/encryption.cpp \
+    ../../encryption/file_encryption.cpp \
+    ../../encryption/framing.cpp \
+    ../../encryption/stream.cpp \
+    ../../encryption/substitution.cpp
+
+HEADERS += \
+    ../harness/bench.hh
@@ -0,0 +1,601 @@
+/* Encryption benchmarks
+ *
+ * Benchmarks of the encryption program: validation of single keys and of
+ * batches of keys, decryption, and encryption of short words and long
+ * texts with the function encrypt, with a compiled Cipher, with a
+ * Fixed_cipher whose key is known at compile time and with each
+ * substitution kernel the CPU supports. Polyalphabetic encryption with
+ * sequences of 1 to 128 keys is compared with the single key kernels.
+ * Streaming encryption of a large file is run on one thread and in a
+ * pipeline of 2, 4, ... threads up to the core count, plainly and in
+ * checksummed frames, whose overhead is also measured in memory, and
+ * framed output is verified on 1 to all cores. On POSIX systems,
+ * encryption of a file on disk through memory mappings is compared with a
+ * buffered read and write loop.
+ */
+
+#include "bench.hh"
+#include "cipher.hh"
+#include "encryption.hh"
+#include "file_encryption.hh"
+#include "fixed_cipher.hh"
+#include "framing.hh"
+#include "stream.hh"
+#include "substitution.hh"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define BENCH_FILES 1
+#endif
+
+using namespace std;
+
+namespace {
+
+const string KEY = "qwertyuiopasdfghjklzxcvbnm";
+constexpr char FIXED_KEY[] = "qwertyuiopasdfghjklzxcvbnm";
+
+// amount of keys in the batch validation benchmarks
+const size_t KEY_BATCH_SIZE = 1000000;
+
+// size of the file encrypted by the stream benchmarks
+const size_t STREAM_FILE_SIZE = 256 << 20;
+
+#ifdef _WIN32
+const char* NULL_DEVICE = "NUL";
+#else
+const char* NULL_DEVICE = "/dev/null";
+#endif
+
+/**
+ * @brief random_text Creates a text of random lowercase letters
+ * @param length length of the text
+ * @return the text
+ */
+string random_text(size_t length)
+{
+    mt19937 rng(1);
+    uniform_int_distribution<int> letter('a', 'z');
+    string text(length, 'a');
+    for(char& c : text)
+    {
+        c = static_cast<char>(letter(rng));
+    }
+    return text;
+}
+
+/**
+ * @brief random_words Creates a text of random words of lowercase letters
+ * separated by spaces and line breaks
+ * @param length length of the text
+ * @return the text
+ */
+string random_words(size_t length)
+{
+    mt19937 rng(1);
+    uniform_int_distribution<int> letter('a', 'z');
+    uniform_int_distribution<int> word_length(1, 9);
+    string text;
+    text.reserve(length);
+    while(text.size() < length)
+    {
+        for(int i = word_length(rng); i > 0; --i)
+        {
+            text += static_cast<char>(letter(rng));
+        }
+        text += text.size() % 80 < 70 ? ' ' : '\n';
+    }
+    text.resize(length);
+    return text;
+}
+
+/**
+ * @brief random_keys Creates a batch of keys where every fourth key is
+ * invalid: too short, with an uppercase letter or with a duplicate letter
+ * @param count amount of keys
+ * @return the keys
+ */
+vector<string> random_keys(size_t count)
+{
+    mt19937 rng(1);
+    string alphabet = "abcdefghijklmnopqrstuvwxyz";
+    vector<string> keys;
+    keys.reserve(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        shuffle(alphabet.begin(), alphabet.end(), rng);
+        string key = alphabet;
+        switch(i % 12)
+        {
+        case 3:
+            key.pop_back();
+            break;
+        case 7:
+            key.at(rng() % 26) = 'Q';
+            break;
+        case 11:
+            key.at(25) = key.at(rng() % 25);
+            break;
+        }
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+/**
+ * @brief quadratic_key_check Checks a key like check_key_validity did before
+ * the single pass check, for comparison: the key by value and a duplicate
+ * scan over all pairs of letters
+ */
+bool quadratic_key_check(string key)
+{
+    if(key.length() != 26 or not check_if_lowercase(key))
+    {
+        return false;
+    }
+    for(string::size_type i = 0; i < key.length() - 1; ++i)
+    {
+        for(string::size_type j = i + 1; j < key.length(); ++j)
+        {
+            if(key[i] == key[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void bench_validation(Bench_runner& runner)
+{
+    const vector<string> keys = random_keys(KEY_BATCH_SIZE);
+    const string batch = "/" + to_string(KEY_BATCH_SIZE);
+
+    runner.run("encryption/validate_keys/quadratic" + batch, [&keys](Bench_state& state) {
+        size_t valid_keys = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(const string& key : keys)
+            {
+                valid_keys += quadratic_key_check(key);
+            }
+        }
+        do_not_optimize(valid_keys);
+        state.set_items_processed(1.0 * keys.size() * state.iterations());
+    });
+
+    runner.run("encryption/validate_keys/bitmask" + batch, [&keys](Bench_state& state) {
+        vector<bool> valid;
+        size_t valid_keys = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            valid_keys += validate_keys(keys, valid);
+        }
+        do_not_optimize(valid_keys);
+        state.set_items_processed(1.0 * keys.size() * state.iterations());
+    });
+}
+
+void bench_encrypt(Bench_runner& runner, size_t length)
+{
+    const string text = random_text(length);
+
+    runner.run("encryption/encrypt/" + to_string(length), [&text](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            string encrypted = encrypt(text, KEY);
+            do_not_optimize(encrypted);
+        }
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+
+    runner.run("encryption/cipher_encrypt/" + to_string(length), [&text](Bench_state& state) {
+        Cipher cipher;
+        cipher.set_key(KEY);
+        string encrypted(text.size(), '\0');
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            cipher.encrypt(text.data(), text.size(), &encrypted[0]);
+            do_not_optimize(encrypted);
+        }
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+
+    runner.run("encryption/fixed_cipher_encrypt/" + to_string(length), [&text](Bench_state& state) {
+        string encrypted(text.size(), '\0');
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Fixed_cipher<FIXED_KEY>::encrypt(text.data(), text.size(), &encrypted[0]);
+            do_not_optimize(encrypted);
+        }
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+
+    runner.run("encryption/cipher_decrypt/" + to_string(length), [&text](Bench_state& state) {
+        Cipher cipher;
+        cipher.set_key(KEY);
+        string decrypted(text.size(), '\0');
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            cipher.decrypt(text.data(), text.size(), &decrypted[0]);
+            do_not_optimize(decrypted);
+        }
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+}
+
+void bench_kernels(Bench_runner& runner, size_t length)
+{
+    const string text = random_text(length);
+    Substitution_tables tables;
+    compile_substitution(tables, KEY.data(), KEY.length());
+
+    for(Substitution_kernel kernel : {SCALAR_KERNEL, SSSE3_KERNEL, AVX2_KERNEL, AVX512_KERNEL})
+    {
+        if(kernel > best_substitution_kernel())
+        {
+            break;
+        }
+        runner.run(string("encryption/substitute/") + substitution_kernel_name(kernel)
+                   + "/" + to_string(length), [&](Bench_state& state) {
+            string encrypted(text.size(), '\0');
+            for(size_t i = 0; i < state.iterations(); ++i)
+            {
+                substitute(kernel, tables, text.data(), text.size(), &encrypted[0]);
+                do_not_optimize(encrypted);
+            }
+            state.set_bytes_processed(1.0 * text.size() * state.iterations());
+        });
+    }
+}
+
+/**
+ * @brief random_key_sequence Creates a sequence of random valid keys
+ * @param count amount of keys
+ * @return the keys
+ */
+vector<string> random_key_sequence(size_t count)
+{
+    mt19937 rng(2);
+    string alphabet = "abcdefghijklmnopqrstuvwxyz";
+    vector<string> keys;
+    for(size_t i = 0; i < count; ++i)
+    {
+        shuffle(alphabet.begin(), alphabet.end(), rng);
+        keys.push_back(alphabet);
+    }
+    return keys;
+}
+
+// Encrypts words with sequences of keys, which cost each vector kernel
+// more the more keys there are, next to the same words with a single key.
+void bench_key_sequences(Bench_runner& runner, size_t length)
+{
+    const string text = random_words(length);
+    Substitution_tables tables;
+    compile_substitution(tables, KEY.data(), KEY.length());
+
+    for(Substitution_kernel kernel : {SCALAR_KERNEL, SSSE3_KERNEL, AVX2_KERNEL, AVX512_KERNEL})
+    {
+        if(kernel > best_substitution_kernel())
+        {
+            break;
+        }
+        const string name = string("encryption/key_sequence/") + substitution_kernel_name(kernel);
+
+        runner.run(name + "/single_key/" + to_string(length), [&](Bench_state& state) {
+            string encrypted(text.size(), '\0');
+            for(size_t i = 0; i < state.iterations(); ++i)
+            {
+                substitute(kernel, tables, text.data(), text.size(), &encrypted[0]);
+                do_not_optimize(encrypted);
+            }
+            state.set_bytes_processed(1.0 * text.size() * state.iterations());
+        });
+
+        for(size_t keys : {1, 2, 4, 8, 16, 32, 64, 128})
+        {
+            Key_sequence_tables sequence;
+            compile_key_sequence(sequence, random_key_sequence(keys));
+            runner.run(name + "/keys:" + to_string(keys) + "/" + to_string(length), [&](Bench_state& state) {
+                string encrypted(text.size(), '\0');
+                for(size_t i = 0; i < state.iterations(); ++i)
+                {
+                    substitute(kernel, sequence, 0, text.data(), text.size(), &encrypted[0]);
+                    do_not_optimize(encrypted);
+                }
+                state.set_bytes_processed(1.0 * text.size() * state.iterations());
+            });
+        }
+    }
+
+    runner.run("encryption/cipher_encrypt/keys:3/" + to_string(length), [&text](Bench_state& state) {
+        Cipher cipher;
+        cipher.set_keys(random_key_sequence(3));
+        string encrypted(text.size(), '\0');
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            cipher.encrypt(text.data(), text.size(), &encrypted[0]);
+            do_not_optimize(encrypted);
+        }
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+}
+
+// Compares encrypting words with encrypting them in frames, each of which
+// is checksummed after it is encrypted, and the checksum on its own.
+void bench_framing(Bench_runner& runner, size_t length)
+{
+    const string text = random_words(length);
+    Cipher cipher;
+    cipher.set_key(KEY);
+
+    runner.run("encryption/crc32c/" + to_string(length), [&text](Bench_state& state) {
+        uint32_t crc = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            crc = crc32c(crc, text.data(), text.size());
+        }
+        do_not_optimize(crc);
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+
+    runner.run("encryption/cipher_encrypt/words/" + to_string(length), [&](Bench_state& state) {
+        string encrypted(text.size(), '\0');
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            cipher.encrypt(text.data(), text.size(), &encrypted[0]);
+            do_not_optimize(encrypted);
+        }
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+
+    runner.run("encryption/cipher_encrypt_framed/words/" + to_string(length), [&](Bench_state& state) {
+        string encrypted(text.size(), '\0');
+        char header[FRAME_HEADER_SIZE];
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(size_t frame = 0; frame < text.size(); frame += FRAME_SIZE)
+            {
+                size_t size = min(FRAME_SIZE, text.size() - frame);
+                size_t length = cipher.encrypt(text.data() + frame, size, &encrypted[frame]);
+                write_frame_header(header, &encrypted[frame], static_cast<uint32_t>(length),
+                                   static_cast<uint32_t>(frame / FRAME_SIZE));
+                do_not_optimize(header);
+            }
+            do_not_optimize(encrypted);
+        }
+        state.set_bytes_processed(1.0 * text.size() * state.iterations());
+    });
+}
+
+/**
+ * @brief words_file Creates a temporary file of STREAM_FILE_SIZE bytes of words
+ * @param framed True to encrypt the words into frames
+ * @return the file at its start, or nullptr if it cannot be created
+ */
+FILE* words_file(bool framed)
+{
+    FILE* file = tmpfile();
+    if(file == nullptr)
+    {
+        return nullptr;
+    }
+    if(framed)
+    {
+        FILE* words = words_file(false);
+        Cipher cipher;
+        cipher.set_key(KEY);
+        encrypt_framed_stream(cipher, words, file);
+        fclose(words);
+    }
+    else
+    {
+        const string block = random_words(STREAM_CHUNK_SIZE);
+        for(size_t written = 0; written < STREAM_FILE_SIZE; written += block.size())
+        {
+            fwrite(block.data(), 1, block.size(), file);
+        }
+    }
+    rewind(file);
+    return file;
+}
+
+// Streams a temporary file of words to the null device, so each iteration
+// reads STREAM_FILE_SIZE bytes through a bounded amount of memory.
+void bench_stream(Bench_runner& runner, bool passthrough, bool framed, unsigned int threads)
+{
+    runner.run(string("encryption/stream/") + (passthrough ? "passthrough" : "drop")
+               + (framed ? "/framed" : "") + "/threads:" + to_string(threads),
+               [passthrough, framed, threads](Bench_state& state) {
+        state.pause_timing();
+        FILE* in = words_file(false);
+        FILE* out = fopen(NULL_DEVICE, "wb");
+        if(in == nullptr or out == nullptr)
+        {
+            state.set_counter("error", 1);
+            return;
+        }
+        Cipher cipher;
+        cipher.set_key(KEY);
+        cipher.set_passthrough(passthrough);
+        state.resume_timing();
+
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            rewind(in);
+            if(framed)
+            {
+                encrypt_framed_stream(cipher, in, out, FRAME_SIZE, threads);
+            }
+            else
+            {
+                encrypt_stream(cipher, in, out, STREAM_CHUNK_SIZE, threads);
+            }
+        }
+
+        state.pause_timing();
+        fclose(in);
+        fclose(out);
+        state.set_bytes_processed(1.0 * STREAM_FILE_SIZE * state.iterations());
+    });
+}
+
+// Verifies a framed file of encrypted words on the given amount of threads.
+void bench_verify(Bench_runner& runner, unsigned int threads)
+{
+    runner.run("encryption/verify/threads:" + to_string(threads), [threads](Bench_state& state) {
+        state.pause_timing();
+        FILE* in = words_file(true);
+        if(in == nullptr)
+        {
+            state.set_counter("error", 1);
+            return;
+        }
+        fseek(in, 0, SEEK_END);
+        const double size = ftell(in);
+        state.resume_timing();
+
+        bool intact = true;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            rewind(in);
+            intact = verify_frames(in, threads) and intact;
+        }
+
+        state.pause_timing();
+        fclose(in);
+        state.set_counter("intact", intact);
+        state.set_bytes_processed(size * state.iterations());
+    });
+}
+
+#ifdef BENCH_FILES
+
+/**
+ * @brief temporary_path Creates an empty temporary file
+ * @return path of the file
+ */
+string temporary_path()
+{
+    char path[] = "/tmp/encryption_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if(fd >= 0)
+    {
+        close(fd);
+    }
+    return path;
+}
+
+// Encrypts a file of words on disk into another file, or over itself, with
+// characters passed through so that every round has the same size.
+void bench_files(Bench_runner& runner)
+{
+    const string in_path = temporary_path();
+    const string out_path = temporary_path();
+    FILE* in = fopen(in_path.c_str(), "wb");
+    const string block = random_words(STREAM_CHUNK_SIZE);
+    for(size_t written = 0; in != nullptr and written < STREAM_FILE_SIZE; written += block.size())
+    {
+        fwrite(block.data(), 1, block.size(), in);
+    }
+    if(in != nullptr)
+    {
+        fclose(in);
+    }
+
+    Cipher cipher;
+    cipher.set_key(KEY);
+    cipher.set_passthrough(true);
+
+    runner.run("encryption/file/buffered", [&](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            FILE* in = fopen(in_path.c_str(), "rb");
+            FILE* out = fopen(out_path.c_str(), "wb");
+            encrypt_stream(cipher, in, out);
+            fclose(in);
+            fclose(out);
+        }
+        state.set_bytes_processed(1.0 * STREAM_FILE_SIZE * state.iterations());
+    });
+
+    runner.run("encryption/file/mapped", [&](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            encrypt_file_to(cipher, in_path, out_path);
+        }
+        state.set_bytes_processed(1.0 * STREAM_FILE_SIZE * state.iterations());
+    });
+
+    runner.run("encryption/file/mapped_in_place", [&](Bench_state& state) {
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            encrypt_file_in_place(cipher, in_path);
+        }
+        state.set_bytes_processed(1.0 * STREAM_FILE_SIZE * state.iterations());
+    });
+
+    remove(in_path.c_str());
+    remove(out_path.c_str());
+}
+
+#endif
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    Bench_runner runner(argc, argv);
+
+    runner.run("encryption/check_key_validity", [](Bench_state& state) {
+        bool valid = true;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            valid = check_key_validity(KEY) and valid;
+        }
+        do_not_optimize(valid);
+        state.set_items_processed(1.0 * state.iterations());
+    });
+
+    bench_validation(runner);
+
+    for(size_t length : {16, 4096, 1 << 20})
+    {
+        bench_encrypt(runner, length);
+        bench_kernels(runner, length);
+    }
+    bench_key_sequences(runner, 1 << 20);
+    bench_framing(runner, 1 << 20);
+
+    bench_stream(runner, false, false, 1);
+    bench_stream(runner, true, false, 1);
+    bench_stream(runner, false, true, 1);
+    const unsigned int cores = max(1u, thread::hardware_concurrency());
+    for(unsigned int threads = 2; threads < cores; threads *= 2)
+    {
+        bench_stream(runner, false, false, threads);
+        bench_stream(runner, false, true, threads);
+    }
+    bench_stream(runner, false, false, max(2u, cores));
+    bench_stream(runner, false, true, max(2u, cores));
+
+    for(unsigned int threads = 1; threads < cores; threads *= 2)
+    {
+        bench_verify(runner, threads);
+    }
+    bench_verify(runner, cores);
+
+#ifdef BENCH_FILES
+    bench_files(runner);
+#endif
+
+    return runner.finish();
+}
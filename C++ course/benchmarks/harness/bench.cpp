@@ -0,0 +1,338 @@
+/* Benchmark harness
+ *
+ * Runs the benchmark bodies, prints a result table and writes the JSON.
+ */
+
+#include "bench.hh"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const size_t MAX_ITERATIONS = 1000000000;
+
+/**
+ * @brief reset_peak_rss Resets the peak resident set size of the process
+ * @return true if the kernel reset it, so a later peak_rss_kb covers only
+ * what ran in between
+ */
+bool reset_peak_rss()
+{
+#if defined(__linux__)
+    // Writing 5 to clear_refs resets VmHWM to the current resident size.
+    ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief peak_rss_kb Returns the peak resident set size of the process
+ * @param since_reset true to read the peak since the last reset_peak_rss
+ * @return peak RSS in kilobytes, or 0 if it is not available
+ */
+long peak_rss_kb(bool since_reset)
+{
+#if defined(__linux__)
+    if(since_reset)
+    {
+        ifstream status("/proc/self/status");
+        string line;
+        while(getline(status, line))
+        {
+            if(line.compare(0, 6, "VmHWM:") == 0)
+            {
+                return strtol(line.c_str() + 6, nullptr, 10);
+            }
+        }
+        return 0;
+    }
+#else
+    (void)since_reset;
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    // The peak of the whole process so far, which never goes down.
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief json_string Quotes a string for JSON
+ */
+string json_string(const string& str)
+{
+    string quoted = "\"";
+    for(char c : str)
+    {
+        if(c == '"' or c == '\\')
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+}
+
+
+Bench_state::Bench_state(size_t iterations):
+    iterations_(iterations), running_(false), cpu_start_(0), real_seconds_(0),
+    cpu_seconds_(0), items_(0), bytes_(0)
+{
+}
+
+
+size_t Bench_state::iterations() const
+{
+    return iterations_;
+}
+
+
+void Bench_state::pause_timing()
+{
+    stop();
+}
+
+
+void Bench_state::resume_timing()
+{
+    start();
+}
+
+
+void Bench_state::set_items_processed(double items)
+{
+    items_ = items;
+}
+
+
+void Bench_state::set_bytes_processed(double bytes)
+{
+    bytes_ = bytes;
+}
+
+
+void Bench_state::set_counter(const string& name, double value)
+{
+    counters_.push_back(make_pair(name, value));
+}
+
+
+void Bench_state::start()
+{
+    if(not running_)
+    {
+        running_ = true;
+        cpu_start_ = clock();
+        real_start_ = chrono::steady_clock::now();
+    }
+}
+
+
+void Bench_state::stop()
+{
+    if(running_)
+    {
+        real_seconds_ += chrono::duration<double>(chrono::steady_clock::now()
+                                                  - real_start_).count();
+        cpu_seconds_ += double(clock() - cpu_start_) / CLOCKS_PER_SEC;
+        running_ = false;
+    }
+}
+
+
+Bench_runner::Bench_runner(int argc, char* argv[]):
+    executable_(argc > 0 ? argv[0] : ""), min_time_(0.5), options_ok_(true)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        if(option.compare(0, 9, "--filter=") == 0)
+        {
+            filter_ = option.substr(9);
+        }
+        else if(option.compare(0, 11, "--min-time=") == 0)
+        {
+            min_time_ = atof(option.substr(11).c_str());
+        }
+        else if(option.compare(0, 7, "--json=") == 0)
+        {
+            json_path_ = option.substr(7);
+        }
+        else
+        {
+            cerr << "Unknown option " << option << endl
+                 << "Usage: " << executable_
+                 << " [--filter=REGEX] [--min-time=SECONDS] [--json=FILE]" << endl;
+            options_ok_ = false;
+        }
+    }
+}
+
+
+void Bench_runner::run(const string& name, const function<void(Bench_state&)>& body)
+{
+    if(not options_ok_ or (not filter_.empty() and not regex_search(name, regex(filter_))))
+    {
+        return;
+    }
+
+    // Bodies that pause the clocks for setup can spend much longer than the
+    // timed part, so a run also ends once it has taken ten minimum times
+    // of wall time.
+    const double max_wall_time = 10 * min_time_;
+
+    size_t iterations = 1;
+    while(true)
+    {
+        Bench_state state(iterations);
+        bool peak_reset = reset_peak_rss();
+        chrono::steady_clock::time_point wall_start = chrono::steady_clock::now();
+        state.start();
+        body(state);
+        state.stop();
+        double wall_seconds = chrono::duration<double>(chrono::steady_clock::now()
+                                                       - wall_start).count();
+
+        if(state.real_seconds_ >= min_time_ or wall_seconds >= max_wall_time
+           or iterations >= MAX_ITERATIONS)
+        {
+            Result result;
+            result.name = name;
+            result.iterations = iterations;
+            result.real_ns = state.real_seconds_ * 1e9 / iterations;
+            result.cpu_ns = state.cpu_seconds_ * 1e9 / iterations;
+            result.items_per_second = state.real_seconds_ > 0 ? state.items_ / state.real_seconds_ : 0;
+            result.bytes_per_second = state.real_seconds_ > 0 ? state.bytes_ / state.real_seconds_ : 0;
+            result.peak_rss_kb = peak_rss_kb(peak_reset);
+            result.peak_rss_per_run = peak_reset;
+            result.counters = state.counters_;
+            results_.push_back(result);
+
+            printf("%-56s %14.1f ns %14.1f ns %11zu", name.c_str(), result.real_ns,
+                   result.cpu_ns, iterations);
+            if(result.items_per_second > 0)
+            {
+                printf("  %10.4g items/s", result.items_per_second);
+            }
+            if(result.bytes_per_second > 0)
+            {
+                printf("  %10.4g MB/s", result.bytes_per_second / 1e6);
+            }
+            for(const pair<string, double>& counter : result.counters)
+            {
+                printf("  %s=%g", counter.first.c_str(), counter.second);
+            }
+            printf("\n");
+            fflush(stdout);
+            return;
+        }
+
+        // Aim a bit past the minimum time, but grow at most tenfold at once.
+        double scale = state.real_seconds_ > 0 ? min_time_ * 1.4 / state.real_seconds_ : 10;
+        if(wall_seconds > 0 and scale > max_wall_time / wall_seconds)
+        {
+            scale = max_wall_time / wall_seconds;
+        }
+        if(scale > 10)
+        {
+            scale = 10;
+        }
+        size_t next = static_cast<size_t>(iterations * scale);
+        iterations = next > iterations ? next : iterations + 1;
+        if(iterations > MAX_ITERATIONS)
+        {
+            iterations = MAX_ITERATIONS;
+        }
+    }
+}
+
+
+int Bench_runner::finish()
+{
+    if(not options_ok_)
+    {
+        return EXIT_FAILURE;
+    }
+    if(json_path_.empty())
+    {
+        return EXIT_SUCCESS;
+    }
+
+    ofstream json(json_path_);
+    if(not json)
+    {
+        cerr << "Cannot write " << json_path_ << endl;
+        return EXIT_FAILURE;
+    }
+
+    time_t now = time(nullptr);
+    char date[64];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    json << "{\n  \"context\": {\n"
+         << "    \"date\": " << json_string(date) << ",\n"
+         << "    \"executable\": " << json_string(executable_) << ",\n"
+         << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+         << "    \"library_build_type\": \"release\"\n"
+#else
+         << "    \"library_build_type\": \"debug\"\n"
+#endif
+         << "  },\n  \"benchmarks\": [";
+
+    for(size_t i = 0; i < results_.size(); ++i)
+    {
+        const Result& result = results_.at(i);
+        json << (i == 0 ? "\n" : ",\n")
+             << "    {\n"
+             << "      \"name\": " << json_string(result.name) << ",\n"
+             << "      \"run_name\": " << json_string(result.name) << ",\n"
+             << "      \"run_type\": \"iteration\",\n"
+             << "      \"iterations\": " << result.iterations << ",\n"
+             << "      \"real_time\": " << result.real_ns << ",\n"
+             << "      \"cpu_time\": " << result.cpu_ns << ",\n"
+             << "      \"time_unit\": \"ns\",\n"
+             << "      " << (result.peak_rss_per_run ? "\"peak_rss_kb\"" : "\"process_peak_rss_kb\"")
+             << ": " << result.peak_rss_kb;
+        if(result.items_per_second > 0)
+        {
+            json << ",\n      \"items_per_second\": " << result.items_per_second;
+        }
+        if(result.bytes_per_second > 0)
+        {
+            json << ",\n      \"bytes_per_second\": " << result.bytes_per_second;
+        }
+        for(const pair<string, double>& counter : result.counters)
+        {
+            json << ",\n      " << json_string(counter.first) << ": " << counter.second;
+        }
+        json << "\n    }";
+    }
+    json << "\n  ]\n}\n";
+
+    return json ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,142 @@
+/* Benchmark harness
+ * -----------------
+ * A small self-contained harness for timing the hot paths of the course
+ * programs. Each benchmark body runs the measured code state.iterations()
+ * times; the runner grows the iteration count until one run takes at
+ * least the minimum time.
+ *
+ * Command line options of every benchmark program:
+ *   --filter=REGEX     run only the benchmarks whose name matches
+ *   --min-time=SECONDS minimum time of one run (default 0.5)
+ *   --json=FILE        also write the results to FILE as JSON
+ *
+ * The JSON has the layout of Google Benchmark's output, so two runs can be
+ * compared with its tools/compare.py.
+ * */
+
+#ifndef BENCH_HH
+#define BENCH_HH
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Bench_state
+{
+public:
+    /**
+     * @brief iterations Returns how many times the body must run the measured code
+     */
+    std::size_t iterations() const;
+
+    /**
+     * @brief pause_timing Stops the clocks, e.g. for setup work inside the body
+     */
+    void pause_timing();
+
+    /**
+     * @brief resume_timing Restarts the clocks stopped by pause_timing
+     */
+    void resume_timing();
+
+    /**
+     * @brief set_items_processed Sets the amount of items processed by all
+     * iterations, reported as items per second
+     */
+    void set_items_processed(double items);
+
+    /**
+     * @brief set_bytes_processed Sets the amount of bytes processed by all
+     * iterations, reported as bytes per second
+     */
+    void set_bytes_processed(double bytes);
+
+    /**
+     * @brief set_counter Reports an extra named value with the results
+     */
+    void set_counter(const std::string& name, double value);
+
+private:
+    friend class Bench_runner;
+
+    explicit Bench_state(std::size_t iterations);
+
+    void start();
+    void stop();
+
+    std::size_t iterations_;
+    bool running_;
+    std::chrono::steady_clock::time_point real_start_;
+    std::clock_t cpu_start_;
+    double real_seconds_;
+    double cpu_seconds_;
+    double items_;
+    double bytes_;
+    std::vector<std::pair<std::string, double>> counters_;
+};
+
+
+class Bench_runner
+{
+public:
+    /**
+     * @brief Bench_runner Constructor: reads the options from the command line
+     */
+    Bench_runner(int argc, char* argv[]);
+
+    /**
+     * @brief run Runs the benchmark with the given name, unless it is filtered out
+     * @param name benchmark name, e.g. "cards/add_range/1000000"
+     * @param body the benchmark body
+     */
+    void run(const std::string& name, const std::function<void(Bench_state&)>& body);
+
+    /**
+     * @brief finish Writes the JSON file, if one was asked for
+     * @return exit status for main
+     */
+    int finish();
+
+private:
+    struct Result
+    {
+        std::string name;
+        std::size_t iterations;
+        double real_ns;
+        double cpu_ns;
+        double items_per_second;
+        double bytes_per_second;
+        long peak_rss_kb;
+        bool peak_rss_per_run;
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    std::string executable_;
+    std::string filter_;
+    double min_time_;
+    std::string json_path_;
+    bool options_ok_;
+    std::vector<Result> results_;
+};
+
+
+/**
+ * @brief do_not_optimize Keeps the compiler from dropping the computation
+ * of a value that is otherwise unused
+ */
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+#endif // BENCH_HH
@@ -0,0 +1,475 @@
+/* Mölkky benchmarks
+ *
+ * Benchmarks of the scoring of the molkky program: single throws of a
+ * Player, and turns of tens of thousands of games side by side, scored
+ * with Player objects and with a Game_batch. The Monte Carlo simulation is
+ * run on one thread and on 2, 4, ... threads up to the amount of cores, to
+ * show how it scales. The win table is timed both when it is built and when
+ * it is queried. Full games of 2-8 players are played with Game. A game log
+ * of 10^7 throws is written, loaded and replayed.
+ */
+
+#include "bench.hh"
+#include "game.hh"
+#include "game_batch.hh"
+#include "game_log.hh"
+#include "player.hh"
+#include "rules.hh"
+#include "simulation.hh"
+#include "win_table.hh"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief random_throws Creates throws of 0-12 points
+ * @param count amount of throws
+ * @return the throws
+ */
+std::vector<int> random_throws(size_t count)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> points(0, 12);
+    std::vector<int> throws(count);
+    for(int& pts : throws)
+    {
+        pts = points(rng);
+    }
+    return throws;
+}
+
+// amount of turns played in the games of the turn benchmarks
+const int TURNS = 32;
+
+/**
+ * @brief random_turns Creates throws of 0-12 points for every game of each turn
+ * @param games amount of games
+ * @return the throws of each turn
+ */
+std::vector<std::vector<unsigned char>> random_turns(size_t games)
+{
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> points(0, 12);
+    std::vector<std::vector<unsigned char>> turns(TURNS, std::vector<unsigned char>(games));
+    for(std::vector<unsigned char>& turn : turns)
+    {
+        for(unsigned char& pts : turn)
+        {
+            pts = static_cast<unsigned char>(points(rng));
+        }
+    }
+    return turns;
+}
+
+// Plays TURNS turns of two-player games, with a Player object for each
+// player and with a Game_batch. A finished game skips the rest of its
+// throws in both.
+void bench_turns(Bench_runner& runner, size_t games)
+{
+    const std::vector<std::vector<unsigned char>> turns = random_turns(games);
+
+    runner.run("molkky/turns/player_objects/games:" + std::to_string(games), [&](Bench_state& state) {
+        size_t finished = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            state.pause_timing();
+            std::vector<Player> players(2 * games, Player("Matti"));
+            std::vector<bool> won(games, false);
+            state.resume_timing();
+
+            for(int turn = 0; turn < TURNS; ++turn)
+            {
+                for(size_t game = 0; game < games; ++game)
+                {
+                    if(won[game])
+                    {
+                        continue;
+                    }
+                    Player& player = players[2 * game + turn % 2];
+                    player.add_points(turns[turn][game]);
+                    if(player.has_won())
+                    {
+                        won[game] = true;
+                        ++finished;
+                    }
+                }
+            }
+        }
+        do_not_optimize(finished);
+        state.set_items_processed(1.0 * games * TURNS * state.iterations());
+    });
+
+    runner.run("molkky/turns/game_batch/games:" + std::to_string(games), [&](Bench_state& state) {
+        Game_batch batch(games, 2);
+        size_t finished = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            batch.reset();
+            for(int turn = 0; turn < TURNS; ++turn)
+            {
+                batch.apply_turn(turns[turn]);
+            }
+            finished += batch.get_finished_games();
+        }
+        do_not_optimize(finished);
+        state.set_items_processed(1.0 * games * TURNS * state.iterations());
+    });
+}
+
+
+// amount of games of an iteration of the simulation benchmarks
+const size_t SIMULATED_GAMES = 1 << 18;
+
+// Simulates games between the greedy and setup throw models on the given
+// amount of threads.
+void bench_simulation(Bench_runner& runner, unsigned int threads)
+{
+    runner.run("molkky/simulate/threads:" + std::to_string(threads), [threads](Bench_state& state) {
+        const Throw_model first = Throw_model::greedy(0.5);
+        const Throw_model second = Throw_model::setup(0.5);
+        Simulation_options options;
+        options.threads = threads;
+        Simulation_result result;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            options.seed = i;
+            result = simulate(first, second, SIMULATED_GAMES, options);
+            do_not_optimize(result);
+        }
+        state.set_items_processed(1.0 * SIMULATED_GAMES * state.iterations());
+        state.set_counter("first_wins", 1.0 * result.first_wins / result.games);
+    });
+}
+
+
+// Builds win tables and looks up the win probabilities of random scores.
+void bench_win_table(Bench_runner& runner)
+{
+    const Throw_model greedy = Throw_model::greedy(0.5);
+    const Throw_model setup = Throw_model::setup(0.5);
+
+    runner.run("molkky/win_table/build", [&](Bench_state& state) {
+        int sweeps = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            Win_table table(greedy, setup);
+            sweeps = table.get_sweeps();
+            do_not_optimize(table);
+        }
+        state.set_items_processed(1.0 * state.iterations());
+        state.set_counter("sweeps", sweeps);
+    });
+
+    const size_t queries = 1 << 16;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> points(0, 49);
+    std::uniform_int_distribution<int> misses(0, 2);
+    std::vector<unsigned char> scores(5 * queries);
+    for(size_t i = 0; i < queries; ++i)
+    {
+        scores[5 * i] = points(rng);
+        scores[5 * i + 1] = points(rng);
+        scores[5 * i + 2] = misses(rng);
+        scores[5 * i + 3] = misses(rng);
+        scores[5 * i + 4] = rng() % 2;
+    }
+    const Win_table table(greedy, setup);
+
+    runner.run("molkky/win_table/query", [&](Bench_state& state) {
+        double sum = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(size_t query = 0; query < queries; ++query)
+            {
+                const unsigned char* score = &scores[5 * query];
+                sum += table.get_win_probability(0, score[0], score[1], score[2], score[3], score[4]);
+            }
+        }
+        do_not_optimize(sum);
+        state.set_items_processed(1.0 * queries * state.iterations());
+    });
+}
+
+
+// Random numbers drawn in advance, given out in a cycle, so that the game
+// benchmarks do not time a random number generator.
+class Replayed_numbers
+{
+public:
+    using result_type = std::uint64_t;
+
+    Replayed_numbers(const std::vector<std::uint64_t>& numbers):
+        numbers_(numbers), next_(0)
+    {
+    }
+
+    std::uint64_t operator()()
+    {
+        std::uint64_t number = numbers_[next_];
+        next_ = next_ + 1 == numbers_.size() ? 0 : next_ + 1;
+        return number;
+    }
+
+private:
+    const std::vector<std::uint64_t>& numbers_;
+    size_t next_;
+};
+
+// amount of games of an iteration of the game benchmarks
+const int GAMES = 1000;
+
+// Plays full games of the given amount of players, who all throw with the
+// greedy:0.5 model.
+void bench_games(Bench_runner& runner, int players)
+{
+    std::vector<std::string> names;
+    for(int i = 0; i < players; ++i)
+    {
+        names.push_back("Player " + std::to_string(i + 1));
+    }
+    std::mt19937_64 rng(4);
+    std::vector<std::uint64_t> numbers(1 << 16);
+    for(std::uint64_t& number : numbers)
+    {
+        number = rng();
+    }
+
+    runner.run("molkky/games/players:" + std::to_string(players), [&](Bench_state& state) {
+        const Throw_model model = Throw_model::greedy(0.5);
+        Replayed_numbers replayed(numbers);
+        Game game(names);
+        size_t throws = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(int j = 0; j < GAMES; ++j)
+            {
+                game.reset();
+                bool over = false;
+                while(not over)
+                {
+                    int pts = game.get_points(game.get_player_in_turn());
+                    over = game.add_throw(model.throw_points(pts, replayed));
+                    ++throws;
+                }
+            }
+        }
+        do_not_optimize(throws);
+        state.set_items_processed(1.0 * GAMES * state.iterations());
+        state.set_counter("throws_per_game", 1.0 * throws / (GAMES * state.iterations()));
+    });
+}
+
+
+// amount of throws in the game log of the log benchmarks, and the amount of
+// games in it that are played at the same time
+const size_t LOGGED_THROWS = 10000000;
+const size_t LOGGED_GAMES_AT_A_TIME = 1000;
+
+// an event of a logged game: a throw, or the start of a game with the
+// negated amount of players
+struct Logged_event
+{
+    std::uint32_t game;
+    int value;
+};
+
+/**
+ * @brief logged_events Plays games of 2-8 players who throw with the
+ * greedy:0.5 model, many games at a time, until LOGGED_THROWS throws
+ * @return the events of the games in the order they happened
+ */
+std::vector<Logged_event> logged_events()
+{
+    std::mt19937_64 rng(5);
+    const Throw_model model = Throw_model::greedy(0.5);
+    std::vector<Logged_event> events;
+    events.reserve(LOGGED_THROWS + LOGGED_THROWS / 4);
+    std::vector<std::pair<std::uint32_t, Game_state>> games(LOGGED_GAMES_AT_A_TIME);
+    std::uint32_t next_game = 0;
+    auto start = [&](std::pair<std::uint32_t, Game_state>& game) {
+        int players = MIN_PLAYERS + rng() % (MAX_PLAYERS - MIN_PLAYERS + 1);
+        game.first = next_game++;
+        game.second.start(players);
+        events.push_back(Logged_event{game.first, -players});
+    };
+    for(auto& game : games)
+    {
+        start(game);
+    }
+    for(size_t throws = 0; throws < LOGGED_THROWS; ++throws)
+    {
+        auto& game = games[rng() % games.size()];
+        int pts = model.throw_points(game.second.points[game.second.in_turn], rng);
+        events.push_back(Logged_event{game.first, pts});
+        if(game.second.add_throw(pts))
+        {
+            start(game);
+        }
+    }
+    return events;
+}
+
+/**
+ * @brief write_log Writes events to a game log
+ * @param events the events
+ * @param file the log file, empty
+ */
+void write_log(const std::vector<Logged_event>& events, FILE* file)
+{
+    // the names of the players of a game of each size
+    const std::vector<std::string> names = {"Matti", "Teppo", "Liisa", "Aino",
+                                            "Juhani", "Kaisa", "Ville", "Eino"};
+    std::vector<std::vector<std::string>> names_of_games(MAX_PLAYERS + 1);
+    for(int players = MIN_PLAYERS; players <= MAX_PLAYERS; ++players)
+    {
+        names_of_games[players].assign(names.begin(), names.begin() + players);
+    }
+
+    Game_log_writer writer(file);
+    for(const Logged_event& event : events)
+    {
+        if(event.value < 0)
+        {
+            writer.start_game(event.game, names_of_games[-event.value]);
+        }
+        else
+        {
+            writer.add_throw(event.game, event.value);
+        }
+    }
+    writer.flush();
+}
+
+// Writes, loads and replays a game log of LOGGED_THROWS throws. Loading
+// replays every game to its end; the replays of single games play a random
+// amount of throws from the start of the game.
+void bench_game_log(Bench_runner& runner)
+{
+    const std::vector<Logged_event> events = logged_events();
+    FILE* file = std::tmpfile();
+    if(file == nullptr)
+    {
+        return;
+    }
+    write_log(events, file);
+    const double log_bytes = std::ftell(file);
+
+    runner.run("molkky/log/write", [&](Bench_state& state) {
+        bool ok = true;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            state.pause_timing();
+            FILE* written = std::tmpfile();
+            state.resume_timing();
+            if(written == nullptr)
+            {
+                ok = false;
+                break;
+            }
+            write_log(events, written);
+            ok = not std::ferror(written) and ok;
+            std::fclose(written);
+        }
+        state.set_items_processed(1.0 * LOGGED_THROWS * state.iterations());
+        state.set_bytes_processed(log_bytes * state.iterations());
+        state.set_counter("ok", ok);
+    });
+
+    runner.run("molkky/log/load", [&](Bench_state& state) {
+        bool ok = true;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            std::rewind(file);
+            Game_log log;
+            ok = log.load(file) and log.get_throws() == LOGGED_THROWS and ok;
+        }
+        state.set_items_processed(1.0 * LOGGED_THROWS * state.iterations());
+        state.set_bytes_processed(log_bytes * state.iterations());
+        state.set_counter("ok", ok);
+    });
+
+    std::rewind(file);
+    Game_log log;
+    log.load(file);
+    std::fclose(file);
+
+    const size_t replays = 1 << 16;
+    std::mt19937 rng(6);
+    std::vector<std::pair<std::uint32_t, int>> queries(replays);
+    for(auto& query : queries)
+    {
+        query.first = rng() % log.get_games();
+        Game_state state;
+        log.replay(query.first, state);
+        query.second = rng() % (state.throws + 1);
+    }
+
+    runner.run("molkky/log/replay", [&](Bench_state& state) {
+        int throws = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(const auto& query : queries)
+            {
+                Game_state game;
+                log.replay(query.first, query.second, game);
+                throws += game.throws;
+            }
+        }
+        do_not_optimize(throws);
+        state.set_items_processed(1.0 * replays * state.iterations());
+    });
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    Bench_runner runner(argc, argv);
+
+    const std::vector<int> throws = random_throws(1 << 16);
+
+    runner.run("molkky/add_points", [&throws](Bench_state& state) {
+        Player player("Matti");
+        int wins = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            for(int pts : throws)
+            {
+                player.add_points(pts);
+                wins += player.has_won();
+            }
+        }
+        do_not_optimize(wins);
+        state.set_items_processed(1.0 * throws.size() * state.iterations());
+    });
+
+    for(size_t games : {1000, 10000, 100000})
+    {
+        bench_turns(runner, games);
+    }
+
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned int threads = 1; threads < cores; threads *= 2)
+    {
+        bench_simulation(runner, threads);
+    }
+    bench_simulation(runner, cores);
+
+    bench_win_table(runner);
+
+    for(int players = MIN_PLAYERS; players <= MAX_PLAYERS; ++players)
+    {
+        bench_games(runner, players);
+    }
+
+    bench_game_log(runner);
+
+    return runner.finish();
+}
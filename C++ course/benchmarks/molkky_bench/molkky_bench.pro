@@ -0,0 +1,19 @@
+TEMPLATE = app
+CONFIG += console c++11 thread release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../molkky
+
+SOURCES += main.cpp \
+    ../harness/bench.cpp \
+    ../../molkky/game.cpp \
+    ../../molkky/game_batch.cpp \
+    ../../molkky/game_log.cpp \
+    ../../molkky/player.cpp \
+    ../../molkky/simulation.cpp \
+    ../../molkky/throw_model.cpp \
+    ../../molkky/win_table.cpp
+
+HEADERS += \
+    ../harness/bench.hh
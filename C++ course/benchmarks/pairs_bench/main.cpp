@@ -0,0 +1,92 @@
+/* Pairs benchmarks
+ *
+ * Benchmarks of setting up and printing the game board of the pairs
+ * program.
+ */
+
+#include "bench.hh"
+#include "game_board.hh"
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// Stream buffer that throws away everything written to it.
+class Null_buffer : public streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+
+    streamsize xsputn(const char*, streamsize n) override
+    {
+        return n;
+    }
+};
+
+void bench_board(Bench_runner& runner, unsigned int rows, unsigned int columns)
+{
+    const string size = to_string(rows) + "x" + to_string(columns);
+    const double cards = 1.0 * rows * columns;
+
+    runner.run("pairs/init_with_cards/" + size, [=](Bench_state& state) {
+        Game_board_type g_board;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            init_with_empties(g_board, rows, columns);
+            init_with_cards(g_board, i);
+        }
+        state.set_items_processed(cards * state.iterations());
+    });
+
+    // The only free place is just before the place the search starts from,
+    // so the whole board is searched.
+    runner.run("pairs/next_free/" + size, [=](Bench_state& state) {
+        Game_board_type g_board;
+        init_with_empties(g_board, rows, columns);
+        init_with_cards(g_board, 1);
+        g_board.at(0).at(0).set_visibility(EMPTY);
+
+        unsigned int found = 0;
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            found += next_free(g_board, 1);
+        }
+        do_not_optimize(found);
+        state.set_items_processed(cards * state.iterations());
+    });
+
+    runner.run("pairs/print/" + size, [=](Bench_state& state) {
+        Game_board_type g_board;
+        init_with_empties(g_board, rows, columns);
+        init_with_cards(g_board, 1);
+
+        Null_buffer buffer;
+        streambuf* cout_buffer = cout.rdbuf(&buffer);
+        for(size_t i = 0; i < state.iterations(); ++i)
+        {
+            print(g_board);
+        }
+        cout.rdbuf(cout_buffer);
+        state.set_items_processed(cards * state.iterations());
+    });
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    Bench_runner runner(argc, argv);
+
+    bench_board(runner, 4, 5);
+    bench_board(runner, 20, 20);
+    bench_board(runner, 100, 100);
+
+    return runner.finish();
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+CONFIG += console c++11 thread release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../pairs
+
+SOURCES += main.cpp \
+    ../harness/bench.cpp \
+    ../../pairs/card.cpp \
+    ../../pairs/game_board.cpp
+
+HEADERS += \
+    ../harness/bench.hh
@@ -1,150 +1,255 @@
 #include "cards.hh"
+#include "mapped_file.hh"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 
 using namespace std;
 
-// A dynamic structure must have a constructor
-// that initializes the top item as nullptr.
-Cards::Cards(): top_(nullptr)
-{
-}
+namespace {
+
+// Snapshot files start with this header; the ids follow it.
+struct Snapshot_header {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+};
+
+const char SNAPSHOT_MAGIC[4] = {'C', 'R', 'D', 'S'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+static_assert(sizeof(int) == 4, "snapshots store ids as 32-bit integers");
+static_assert(sizeof(Snapshot_header) == 16, "snapshot header is 16 bytes");
+
+// Formats the "<running number>: <id>" lines of the print functions into
+// a local buffer and hands it to the stream in large blocks. Writing line
+// by line with endl would flush the stream once per card.
+class Line_writer {
+
+    public:
+      explicit Line_writer(ostream& s):
+          s_(s), buffer_(BUFFER_SIZE), used_(0), running_number_(1)
+      {
+      }
+
+      void write_line(int id)
+      {
+          if ( used_ + MAX_LINE_LENGTH > BUFFER_SIZE ) {
+             flush();
+          }
+          append_number(running_number_);
+          buffer_[used_++] = ':';
+          buffer_[used_++] = ' ';
+          append_number(id);
+          buffer_[used_++] = '\n';
+          ++running_number_;
+      }
+
+      ~Line_writer()
+      {
+          flush();
+      }
+
+    private:
+      static const size_t BUFFER_SIZE = 64 * 1024;
+      // two 64-bit numbers with sign, separator and newline
+      static const size_t MAX_LINE_LENGTH = 2 * 21 + 3;
+
+      ostream& s_;
+      vector<char> buffer_;
+      size_t used_;
+      long long running_number_;
+
+      void append_number(long long number)
+      {
+          unsigned long long magnitude = number;
+          if ( number < 0 ) {
+             buffer_[used_++] = '-';
+             magnitude = 0 - magnitude;
+          }
+
+          char digits[20];
+          size_t count = 0;
+          do {
+             digits[count++] = static_cast<char>('0' + magnitude % 10);
+             magnitude /= 10;
+          } while ( magnitude != 0 );
+
+          while ( count > 0 ) {
+             buffer_[used_++] = digits[--count];
+          }
+      }
+
+      void flush()
+      {
+          s_.write(buffer_.data(), used_);
+          used_ = 0;
+      }
+};
 
+}
 
 // Adds a new card with the given id as the topmost element.
-void Cards::add(int id)
+template <typename Storage>
+void Basic_cards<Storage>::add(int id)
 {
-    Card_data* new_card = new Card_data{id, nullptr};
-
-    if ( top_ == nullptr ) {
-       top_ = new_card;
-    } else {
-        new_card->next = top_;
-        top_ = new_card;
-    }
+    storage_.push_top(id);
 }
 
 // Prints the content of the data structure with ordinal numbers to the
 // output stream given as a parameter starting from the first element.
-void Cards::print_from_top_to_bottom(std::ostream &s)
+template <typename Storage>
+void Basic_cards<Storage>::print_from_top_to_bottom(std::ostream &s)
 {
-    Card_data* card_to_be_printed = top_;
-    int running_number = 1;
+    Line_writer writer(s);
 
-    while ( card_to_be_printed != nullptr ) {
-       s << running_number << ": " << card_to_be_printed->data << endl;
-       ++running_number;
-       card_to_be_printed = card_to_be_printed->next;
-    }
+    storage_.for_each_top_to_bottom([&](int id) {
+        writer.write_line(id);
+    });
 }
 
-bool Cards::remove(int &id)
+template <typename Storage>
+bool Basic_cards<Storage>::remove(int &id)
 {
-    // empty deck
-    if ( top_ == nullptr ) {
-       return false;
-    }
-
-    Card_data* card_to_be_removed = top_;
-
-    id = card_to_be_removed->data;
-
-    // only 1 item
-    if ( top_->next == nullptr ) {
-       top_ = nullptr;
-    // multiple items
-    } else {
-       top_ = top_->next;
-    }
-
-    delete card_to_be_removed;
-
-    return true;
+    return storage_.pop_top(id);
 }
 
 // Moves the last element of the data structure as the first one.
 // Returns false, if the data structure is empty, otherwise returns true.
-bool Cards::bottom_to_top()
+template <typename Storage>
+bool Basic_cards<Storage>::bottom_to_top()
 {
-    // empty deck
-    if (top_ == nullptr)
-        return false;
-
-    // only one card
-    if (top_->next == nullptr)
-        return true;
-
-    Card_data* index = top_;
-    Card_data* card_to_be_moved = top_;
-
-    while ( index != nullptr ) {
-       if (index->next->next == nullptr) {
-           // second last card reached
-           card_to_be_moved->next->next = top_;
-           top_ = card_to_be_moved->next;
-           card_to_be_moved->next = nullptr;
-       }
-       index = index->next;
-       card_to_be_moved = index;
-    }
-    return true;
+    return storage_.rotate_bottom_to_top();
 }
 
 // Moves the first element of the data structure as the last one.
 // Returns false, if the data structure is empty, otherwise returns true.
-bool Cards::top_to_bottom()
+template <typename Storage>
+bool Basic_cards<Storage>::top_to_bottom()
 {
-    // empty deck
-    if (top_ == nullptr)
-        return false;
-
-    // only one card
-    if (top_->next == nullptr)
-        return true;
-
-    Card_data* last = top_;
-    Card_data* tmp = top_;
+    return storage_.rotate_top_to_bottom();
+}
 
-    // setting "last" as the last card
-    while (last->next != nullptr) {
-        last = last->next;
-    }
+// Prints the content of the data structure with ordinal numbers to the
+// output stream given as a parameter starting from the last element.
+// The deck is walked backwards, so the stack use does not depend on
+// the size of the deck.
+template <typename Storage>
+void Basic_cards<Storage>::print_from_bottom_to_top(std::ostream &s)
+{
+    Line_writer writer(s);
 
-    // second first to first
-    top_ = top_->next;
+    storage_.for_each_bottom_to_top([&](int id) {
+        writer.write_line(id);
+    });
+}
 
-    // original first to last
-    last->next = tmp;
+template <typename Storage>
+void Basic_cards<Storage>::add_range(const int* first, const int* last)
+{
+    storage_.push_range(first, last);
+}
 
-    // emptying the link from the last card
-    last = last->next;
-    last->next = nullptr;
+template <typename Storage>
+size_t Basic_cards<Storage>::remove_n(size_t n, int* out)
+{
+    return storage_.pop_range(n, out);
+}
 
-    return true;
+template <typename Storage>
+bool Basic_cards<Storage>::rotate(ptrdiff_t k)
+{
+    return storage_.rotate(k);
 }
 
-void Cards::print_from_bottom_to_top(std::ostream &s)
+template <typename Storage>
+void Basic_cards<Storage>::splice(Basic_cards& other)
 {
-    recursive_print(top_, s);
+    storage_.splice(other.storage_);
 }
 
-// destructor
-Cards::~Cards()
+template <typename Storage>
+void Basic_cards<Storage>::shuffle(uint64_t seed)
 {
-    while ( top_ != nullptr ) {
-       Card_data* item_to_be_released = top_;
-       top_ = top_->next;
+    storage_.shuffle(seed);
+}
 
-       delete item_to_be_released;
+// The ids are gathered to a buffer and written in large blocks.
+template <typename Storage>
+bool Basic_cards<Storage>::save(const string& path) const
+{
+    ofstream file(path, ios::binary | ios::trunc);
+    if ( not file ) {
+       return false;
     }
+
+    Snapshot_header header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.count = storage_.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const size_t BLOCK_SIZE = 64 * 1024;
+    vector<int> block;
+    block.reserve(BLOCK_SIZE);
+    storage_.for_each_bottom_to_top([&](int id) {
+        block.push_back(id);
+        if ( block.size() == BLOCK_SIZE ) {
+           file.write(reinterpret_cast<const char*>(block.data()),
+                      block.size() * sizeof(int));
+           block.clear();
+        }
+    });
+    file.write(reinterpret_cast<const char*>(block.data()),
+               block.size() * sizeof(int));
+
+    file.close();
+    return not file.fail();
 }
 
-int Cards::recursive_print(Cards::Card_data *top, ostream &s)
+template <typename Storage>
+bool Basic_cards<Storage>::load(const string& path)
 {
-    int running_number = 1;
-    if (top->next != nullptr) {
-        running_number = recursive_print(top->next, s);
+    Mapped_file file;
+    if ( not file.open(path) or file.size() < sizeof(Snapshot_header) ) {
+       return false;
+    }
+
+    Snapshot_header header;
+    memcpy(&header, file.data(), sizeof(header));
+    if ( memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+         or header.version != SNAPSHOT_VERSION
+         or header.count != (file.size() - sizeof(header)) / sizeof(int)
+         or (file.size() - sizeof(header)) % sizeof(int) != 0 ) {
+       return false;
     }
 
-    s << running_number << ": " << top->data << endl;
-    return running_number + 1;
+    // The ids are stored bottommost first, which is the order add_range
+    // expects them in.
+    const int* ids = reinterpret_cast<const int*>(file.data() + sizeof(header));
+    Basic_cards loaded;
+    loaded.add_range(ids, ids + header.count);
+    *this = std::move(loaded);
+    return true;
 }
+
+template <typename Storage>
+size_t Basic_cards<Storage>::size() const
+{
+    return storage_.size();
+}
+
+// The storage policies shipped with the deck.
+template class Basic_cards<List_storage>;
+template class Basic_cards<Ring_storage>;
+
+// Containers of decks move them when they grow only if moving cannot throw.
+static_assert(is_nothrow_move_constructible<Cards>::value
+              and is_nothrow_move_assignable<Cards>::value,
+              "moving a Cards deck only steals its pointers");
+static_assert(is_nothrow_move_constructible<Ring_cards>::value
+              and is_nothrow_move_assignable<Ring_cards>::value,
+              "moving a Ring_cards deck only steals its pointers");
@@ -1,14 +1,27 @@
 #ifndef CARDS_HH
 #define CARDS_HH
 
+#include "list_storage.hh"
+#include "ring_storage.hh"
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <string>
 
-class Cards {
+// A deck of cards. The Storage policy decides how the cards are laid out
+// in memory and is picked at compile time:
+//  - List_storage: circular doubly linked list carved out of slabs
+//  - Ring_storage: contiguous growable ring buffer, best for traversal
+// The member functions are instantiated in cards.cpp for both of them.
+//
+// Copying a deck copies all of its cards. Moving a deck takes over its
+// storage without copying or allocating and leaves the source empty.
+template <typename Storage>
+class Basic_cards {
 
     public:
-      // A dynamic structure must have a constructor
-      // that initializes the top item as nullptr.
-      Cards();
+      typedef typename Storage::iterator iterator;
+      typedef typename Storage::const_iterator const_iterator;
 
       // Adds a new card with the given id as the topmost element.
       void add(int id);
@@ -33,20 +46,77 @@ class Cards {
       // output stream given as a parameter starting from the last element.
       void print_from_bottom_to_top(std::ostream& s);
 
-      // A dynamic data structure must have a destructor
-      // that can be called to deallocate memory,
-      // when the data structure is not needed any more.
-      ~Cards();
+      // Adds the ids from first to last as if add was called for each of
+      // them in order: the card pointed by last - 1 becomes the topmost one.
+      void add_range(const int* first, const int* last);
 
-    private:
-      struct Card_data {
-        int data;
-        Card_data* next;
-      };
+      // Removes at most n topmost cards and writes them to out in the order
+      // they were removed. Returns the amount of cards removed.
+      std::size_t remove_n(std::size_t n, int* out);
+
+      // Moves k cards from the top to the bottom, or -k cards from the
+      // bottom to the top when k is negative, in a single pass.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool rotate(std::ptrdiff_t k);
+
+      // Moves all the cards of other on top of this deck, keeping their
+      // order, and leaves other empty. Constant time with List_storage,
+      // which relinks the cards; Ring_storage copies the cards of other, so
+      // it is linear in the size of other.
+      void splice(Basic_cards& other);
+
+      // Shuffles the deck into a uniformly random order. The same seed
+      // always gives the same order for a deck of the same size, with either
+      // storage policy. Large decks are shuffled on all cores.
+      void shuffle(std::uint64_t seed);
+
+      // Writes the deck to a binary snapshot file: the magic "CRDS", a
+      // 32-bit format version and a 64-bit card count, followed by the ids
+      // as 32-bit integers from the bottommost card to the topmost one, all
+      // in the byte order of the machine.
+      // Returns false, if the file cannot be written, otherwise returns true.
+      bool save(const std::string& path) const;
+
+      // Replaces the deck with the one in the given snapshot file. The file
+      // is memory mapped and the deck is built with one add_range call.
+      // Returns false and leaves the deck unchanged, if the file cannot be
+      // read or is not a snapshot, otherwise returns true.
+      bool load(const std::string& path);
 
-      Card_data* top_;
+      // Returns the amount of cards in the deck.
+      std::size_t size() const;
 
-      int recursive_print(Card_data* top, std::ostream& s);
+      // Iterate over the cards from the topmost one to the bottommost one.
+      // The iterators are bidirectional with List_storage and random access
+      // with Ring_storage.
+      iterator begin()
+      {
+          return storage_.begin();
+      }
+
+      iterator end()
+      {
+          return storage_.end();
+      }
+
+      const_iterator begin() const
+      {
+          return storage_.begin();
+      }
+
+      const_iterator end() const
+      {
+          return storage_.end();
+      }
+
+    private:
+      Storage storage_;
 };
 
+// The deck used by the course programs.
+typedef Basic_cards<List_storage> Cards;
+
+// The same deck laid out contiguously in memory.
+typedef Basic_cards<Ring_storage> Ring_cards;
+
 #endif // CARDS_HH
@@ -1,10 +1,20 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++11 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += main.cpp \
-    cards.cpp
+    cards.cpp \
+    concurrent_cards.cpp \
+    list_storage.cpp \
+    mapped_file.cpp \
+    ring_storage.cpp \
+    shuffle.cpp
 
 HEADERS += \
-    cards.hh
+    cards.hh \
+    concurrent_cards.hh \
+    list_storage.hh \
+    mapped_file.hh \
+    ring_storage.hh \
+    shuffle.hh
@@ -0,0 +1,143 @@
+#include "concurrent_cards.hh"
+#include <new>
+
+using namespace std;
+
+namespace {
+
+uint32_t link_of(uint64_t top)
+{
+    return static_cast<uint32_t>(top);
+}
+
+uint64_t make_top(uint64_t old_top, uint32_t link)
+{
+    uint64_t tag = (old_top >> 32) + 1;
+    return (tag << 32) | link;
+}
+
+}
+
+Concurrent_cards::Concurrent_cards():
+    top_(0), free_top_(0), used_(0), size_(0),
+    chunks_(new atomic<Card_data*>[MAX_CHUNKS])
+{
+    for ( uint32_t i = 0; i < MAX_CHUNKS; ++i ) {
+       chunks_[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+
+// Adds a new card with the given id as the topmost element.
+// A released card is reused if there is one, otherwise the next unused
+// index is claimed.
+void Concurrent_cards::add(int id)
+{
+    uint32_t link = 0;
+    Card_data* new_card = nullptr;
+
+    if ( pop(free_top_, link) ) {
+       new_card = &existing_card(link - 1);
+    } else {
+       uint32_t index = used_.fetch_add(1, memory_order_relaxed);
+       if ( index >= MAX_CARDS ) {
+          used_.fetch_sub(1, memory_order_relaxed);
+          throw bad_alloc();
+       }
+       new_card = &card(index);
+       link = index + 1;
+    }
+
+    new_card->data = id;
+    push(top_, *new_card, link);
+    size_.fetch_add(1, memory_order_relaxed);
+}
+
+bool Concurrent_cards::remove(int &id)
+{
+    uint32_t link = 0;
+    if ( not pop(top_, link) ) {
+       return false;
+    }
+
+    Card_data& removed = existing_card(link - 1);
+    id = removed.data;
+    size_.fetch_sub(1, memory_order_relaxed);
+    push(free_top_, removed, link);
+
+    return true;
+}
+
+size_t Concurrent_cards::size() const
+{
+    return size_.load(memory_order_relaxed);
+}
+
+// destructor
+Concurrent_cards::~Concurrent_cards()
+{
+    for ( uint32_t i = 0; i < MAX_CHUNKS; ++i ) {
+       delete[] chunks_[i].load(memory_order_relaxed);
+    }
+}
+
+Concurrent_cards::Card_data& Concurrent_cards::card(uint32_t index)
+{
+    atomic<Card_data*>& chunk = chunks_[index >> CHUNK_BITS];
+
+    Card_data* cards = chunk.load(memory_order_acquire);
+    if ( cards == nullptr ) {
+       // Several threads may race to allocate the same chunk; the first
+       // one to publish it wins and the others drop their copy.
+       Card_data* new_cards = new Card_data[CHUNK_SIZE];
+       if ( chunk.compare_exchange_strong(cards, new_cards,
+                                          memory_order_acq_rel,
+                                          memory_order_acquire) ) {
+          cards = new_cards;
+       } else {
+          delete[] new_cards;
+       }
+    }
+    return cards[index & (CHUNK_SIZE - 1)];
+}
+
+Concurrent_cards::Card_data& Concurrent_cards::existing_card(uint32_t index) const
+{
+    Card_data* cards = chunks_[index >> CHUNK_BITS].load(memory_order_acquire);
+    return cards[index & (CHUNK_SIZE - 1)];
+}
+
+// Makes the card with the given link the topmost card of the stack.
+// The release order publishes the contents of the card to the thread
+// that pops it.
+void Concurrent_cards::push(atomic<Top>& top, Card_data& card, uint32_t link)
+{
+    Top old_top = top.load(memory_order_relaxed);
+    Top new_top = 0;
+    do {
+       card.next.store(link_of(old_top), memory_order_relaxed);
+       new_top = make_top(old_top, link);
+    } while ( not top.compare_exchange_weak(old_top, new_top,
+                                            memory_order_release,
+                                            memory_order_relaxed) );
+}
+
+// Takes the topmost card of the stack and passes its link to the caller.
+// Reading next of a card that another thread has just taken is harmless:
+// cards are never freed while the deck exists, and the changed tag makes
+// the compare-exchange fail.
+bool Concurrent_cards::pop(atomic<Top>& top, uint32_t& link) const
+{
+    Top old_top = top.load(memory_order_acquire);
+    while ( link_of(old_top) != 0 ) {
+       uint32_t below = existing_card(link_of(old_top) - 1)
+                            .next.load(memory_order_relaxed);
+       if ( top.compare_exchange_weak(old_top, make_top(old_top, below),
+                                      memory_order_acquire,
+                                      memory_order_acquire) ) {
+          link = link_of(old_top);
+          return true;
+       }
+    }
+    return false;
+}
@@ -0,0 +1,76 @@
+#ifndef CONCURRENT_CARDS_HH
+#define CONCURRENT_CARDS_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// A deck of cards that several threads can add cards to and remove cards
+// from at the same time. Both operations are lock-free.
+//
+// The deck is a Treiber stack. Cards live in chunks that are never freed
+// before the deck itself, and they are linked by index. The top of the
+// deck is one 64-bit word holding the index of the top card and a tag
+// that changes on every update, so a thread whose view of the top is
+// stale cannot succeed in its update (the ABA problem). Removed cards go
+// to a second stack of the same kind and are reused by later additions.
+class Concurrent_cards {
+
+    public:
+      Concurrent_cards();
+
+      Concurrent_cards(const Concurrent_cards&) = delete;
+      Concurrent_cards& operator=(const Concurrent_cards&) = delete;
+
+      // Adds a new card with the given id as the topmost element.
+      // Throws std::bad_alloc if the deck already holds MAX_CARDS cards.
+      void add(int id);
+
+      // Removes the topmost card and passes it in the reference parameter id to the caller.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool remove(int& id);
+
+      // Returns the amount of cards in the deck. While other threads are
+      // adding or removing cards, the value is only a snapshot.
+      std::size_t size() const;
+
+      // Must not be called while other threads still use the deck.
+      ~Concurrent_cards();
+
+      static const std::uint32_t CHUNK_BITS = 16;
+      static const std::uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+      static const std::uint32_t MAX_CHUNKS = 1u << 16;
+      static const std::uint64_t MAX_CARDS = std::uint64_t(CHUNK_SIZE) * MAX_CHUNKS - 1;
+
+    private:
+      struct Card_data {
+        // link to the card below: its index + 1, or 0 for none
+        std::atomic<std::uint32_t> next;
+        int data;
+      };
+
+      // A stack top: the tag in the high half and the link to the
+      // topmost card in the low half.
+      typedef std::uint64_t Top;
+
+      std::atomic<Top> top_;
+      std::atomic<Top> free_top_;
+      std::atomic<std::uint32_t> used_;
+      std::atomic<std::size_t> size_;
+
+      std::unique_ptr<std::atomic<Card_data*>[]> chunks_;
+
+      // Returns the card with the given index, allocating its chunk if
+      // no thread has done that yet.
+      Card_data& card(std::uint32_t index);
+
+      // Returns the card with the given index, whose chunk must exist.
+      Card_data& existing_card(std::uint32_t index) const;
+
+      static void push(std::atomic<Top>& top, Card_data& card,
+                       std::uint32_t link);
+      bool pop(std::atomic<Top>& top, std::uint32_t& link) const;
+};
+
+#endif // CONCURRENT_CARDS_HH
@@ -0,0 +1,324 @@
+#include "list_storage.hh"
+#include "shuffle.hh"
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+// A dynamic structure must have a constructor
+// that initializes the top item as nullptr.
+List_storage::List_storage():
+    top_(nullptr), size_(0), newest_slab_(nullptr), slab_size_(0),
+    slab_used_(0), free_list_(nullptr), free_tail_(nullptr)
+{
+}
+
+
+List_storage::List_storage(const List_storage& other):
+    List_storage()
+{
+    other.for_each_bottom_to_top([&](int id) {
+        push_top(id);
+    });
+}
+
+List_storage::List_storage(List_storage&& other) noexcept:
+    List_storage()
+{
+    swap(other);
+}
+
+List_storage& List_storage::operator=(const List_storage& other)
+{
+    List_storage copy(other);
+    swap(copy);
+    return *this;
+}
+
+List_storage& List_storage::operator=(List_storage&& other) noexcept
+{
+    List_storage moved(std::move(other));
+    swap(moved);
+    return *this;
+}
+
+void List_storage::swap(List_storage& other) noexcept
+{
+    std::swap(top_, other.top_);
+    std::swap(size_, other.size_);
+    slabs_.swap(other.slabs_);
+    std::swap(newest_slab_, other.newest_slab_);
+    std::swap(slab_size_, other.slab_size_);
+    std::swap(slab_used_, other.slab_used_);
+    std::swap(free_list_, other.free_list_);
+    std::swap(free_tail_, other.free_tail_);
+}
+
+// Adds a new card with the given id as the topmost element.
+void List_storage::push_top(int id)
+{
+    Card_data* new_card = allocate_card(id);
+
+    if ( top_ == nullptr ) {
+       new_card->next = new_card;
+       new_card->prev = new_card;
+    } else {
+        // the new card goes between the bottom card and the current top
+        new_card->next = top_;
+        new_card->prev = top_->prev;
+        top_->prev->next = new_card;
+        top_->prev = new_card;
+    }
+    top_ = new_card;
+    ++size_;
+}
+
+bool List_storage::pop_top(int &id)
+{
+    // empty deck
+    if ( top_ == nullptr ) {
+       return false;
+    }
+
+    Card_data* card_to_be_removed = top_;
+
+    id = card_to_be_removed->data;
+
+    // only 1 item
+    if ( top_->next == top_ ) {
+       top_ = nullptr;
+    // multiple items
+    } else {
+       top_->prev->next = top_->next;
+       top_->next->prev = top_->prev;
+       top_ = top_->next;
+    }
+
+    release_card(card_to_be_removed);
+    --size_;
+
+    return true;
+}
+
+// Moves the last element of the data structure as the first one.
+// Returns false, if the data structure is empty, otherwise returns true.
+// The deck is circular, so this only moves the top handle backwards.
+bool List_storage::rotate_bottom_to_top()
+{
+    // empty deck
+    if (top_ == nullptr)
+        return false;
+
+    top_ = top_->prev;
+    return true;
+}
+
+// Moves the first element of the data structure as the last one.
+// Returns false, if the data structure is empty, otherwise returns true.
+// The deck is circular, so this only moves the top handle forwards.
+bool List_storage::rotate_top_to_bottom()
+{
+    // empty deck
+    if (top_ == nullptr)
+        return false;
+
+    top_ = top_->next;
+    return true;
+}
+
+void List_storage::push_range(const int* first, const int* last)
+{
+    if ( first == last ) {
+       return;
+    }
+
+    // The new cards are first linked to each other, bottommost first,
+    // and the whole chain is then linked above the current top.
+    Card_data* chain_bottom = allocate_card(*first);
+    Card_data* chain_top = chain_bottom;
+    for ( const int* id = first + 1; id != last; ++id ) {
+       Card_data* new_card = allocate_card(*id);
+       new_card->next = chain_top;
+       chain_top->prev = new_card;
+       chain_top = new_card;
+    }
+
+    if ( top_ == nullptr ) {
+       chain_bottom->next = chain_top;
+       chain_top->prev = chain_bottom;
+    } else {
+       chain_bottom->next = top_;
+       chain_top->prev = top_->prev;
+       top_->prev->next = chain_top;
+       top_->prev = chain_bottom;
+    }
+    top_ = chain_top;
+    size_ += last - first;
+}
+
+size_t List_storage::pop_range(size_t n, int* out)
+{
+    if ( n > size_ ) {
+       n = size_;
+    }
+    if ( n == 0 ) {
+       return 0;
+    }
+
+    Card_data* first_removed = top_;
+    Card_data* last_removed = top_;
+    out[0] = top_->data;
+    for ( size_t i = 1; i < n; ++i ) {
+       last_removed = last_removed->next;
+       out[i] = last_removed->data;
+    }
+
+    if ( n == size_ ) {
+       top_ = nullptr;
+    } else {
+       top_ = last_removed->next;
+       top_->prev = first_removed->prev;
+       first_removed->prev->next = top_;
+    }
+
+    // The removed cards are already linked by next, so the whole chain
+    // goes to the free list at once.
+    last_removed->next = free_list_;
+    if ( free_list_ == nullptr ) {
+       free_tail_ = last_removed;
+    }
+    free_list_ = first_removed;
+
+    size_ -= n;
+    return n;
+}
+
+bool List_storage::rotate(ptrdiff_t k)
+{
+    // empty deck
+    if (top_ == nullptr)
+        return false;
+
+    ptrdiff_t n = static_cast<ptrdiff_t>(size_);
+    ptrdiff_t steps = k % n;
+    if ( steps < 0 ) {
+       steps += n;
+    }
+
+    if ( steps <= n / 2 ) {
+       for ( ptrdiff_t i = 0; i < steps; ++i ) {
+          top_ = top_->next;
+       }
+    } else {
+       for ( ptrdiff_t i = steps; i < n; ++i ) {
+          top_ = top_->prev;
+       }
+    }
+    return true;
+}
+
+void List_storage::splice(List_storage& other)
+{
+    if ( &other == this or other.top_ == nullptr ) {
+       return;
+    }
+
+    // The cards still live in the slabs of other, so this deck takes
+    // them over together with the free cards in them. The slabs are
+    // taken first: growing slabs_ may throw, and until then neither deck
+    // has changed. The newest slab of this deck stays the one new cards
+    // are carved from.
+    slabs_.insert(slabs_.end(), other.slabs_.begin(), other.slabs_.end());
+
+    if ( top_ != nullptr ) {
+       Card_data* other_bottom = other.top_->prev;
+       other_bottom->next = top_;
+       other.top_->prev = top_->prev;
+       top_->prev->next = other.top_;
+       top_->prev = other_bottom;
+    }
+    top_ = other.top_;
+    size_ += other.size_;
+
+    if ( other.free_list_ != nullptr ) {
+       other.free_tail_->next = free_list_;
+       if ( free_list_ == nullptr ) {
+          free_tail_ = other.free_tail_;
+       }
+       free_list_ = other.free_list_;
+    }
+
+    other.top_ = nullptr;
+    other.size_ = 0;
+    other.slabs_.clear();
+    other.newest_slab_ = nullptr;
+    other.slab_size_ = 0;
+    other.slab_used_ = 0;
+    other.free_list_ = nullptr;
+    other.free_tail_ = nullptr;
+}
+
+// The ids are shuffled in a contiguous copy and written back to the cards.
+void List_storage::shuffle(uint64_t seed)
+{
+    vector<int> ids(begin(), end());
+    shuffle_ids(ids.data(), ids.size(), seed);
+    copy(ids.begin(), ids.end(), begin());
+}
+
+bool List_storage::empty() const
+{
+    return top_ == nullptr;
+}
+
+size_t List_storage::size() const
+{
+    return size_;
+}
+
+// destructor
+// Every card lives in one of the slabs, so releasing the slabs
+// releases the whole deck without walking it.
+List_storage::~List_storage()
+{
+    for ( Card_data* slab : slabs_ ) {
+       delete[] slab;
+    }
+}
+
+// Takes a card from the free list, or from the newest slab if the free list
+// is empty. A new slab is allocated only when both are exhausted.
+List_storage::Card_data* List_storage::allocate_card(int id)
+{
+    Card_data* card = free_list_;
+
+    if ( card != nullptr ) {
+       free_list_ = card->next;
+    } else {
+       if ( slab_used_ == slab_size_ ) {
+          if ( slab_size_ == 0 ) {
+             slab_size_ = FIRST_SLAB_SIZE;
+          } else if ( slab_size_ < MAX_SLAB_SIZE ) {
+             slab_size_ *= 2;
+          }
+          newest_slab_ = new Card_data[slab_size_];
+          slabs_.push_back(newest_slab_);
+          slab_used_ = 0;
+       }
+       card = newest_slab_ + slab_used_;
+       ++slab_used_;
+    }
+
+    card->data = id;
+    return card;
+}
+
+// Puts a card back to the free list to be reused by allocate_card.
+void List_storage::release_card(Card_data* card)
+{
+    card->next = free_list_;
+    if ( free_list_ == nullptr ) {
+       free_tail_ = card;
+    }
+    free_list_ = card;
+}
@@ -0,0 +1,268 @@
+#ifndef LIST_STORAGE_HH
+#define LIST_STORAGE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+// Storage policy for Basic_cards that keeps the cards in a circular
+// doubly linked list. Every operation on the top or the bottom of the
+// deck is constant time.
+class List_storage {
+
+    public:
+      // A dynamic structure must have a constructor
+      // that initializes the top item as nullptr.
+      List_storage();
+
+      // Copies the cards of other into slabs owned by the new deck.
+      List_storage(const List_storage& other);
+
+      // Takes over the cards and the slabs of other, leaving it empty.
+      // No cards are copied or allocated.
+      List_storage(List_storage&& other) noexcept;
+
+      List_storage& operator=(const List_storage& other);
+      List_storage& operator=(List_storage&& other) noexcept;
+
+      void swap(List_storage& other) noexcept;
+
+      // Adds a new card with the given id as the topmost element.
+      void push_top(int id);
+
+      // Removes the topmost card and passes it in the reference parameter id to the caller.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool pop_top(int& id);
+
+      // Moves the last element of the data structure as the first one.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool rotate_bottom_to_top();
+
+      // Moves the first element of the data structure as the last one.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool rotate_top_to_bottom();
+
+      // Adds the ids from first to last one by one, so that the card
+      // pointed by last - 1 ends up as the topmost element.
+      void push_range(const int* first, const int* last);
+
+      // Removes at most n topmost cards, writing them to out in the order
+      // they were removed. Returns the amount of cards removed.
+      std::size_t pop_range(std::size_t n, int* out);
+
+      // Moves k cards from the top to the bottom, or -k cards from the
+      // bottom to the top when k is negative, in one walk of at most
+      // half of the deck.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool rotate(std::ptrdiff_t k);
+
+      // Moves all the cards of other on top of this deck, keeping their
+      // order, and leaves other empty. The cards are not copied: the two
+      // lists are relinked and the slabs of other change owner.
+      void splice(List_storage& other);
+
+      // Puts the cards in a uniformly random order that depends only on
+      // the seed and the amount of cards.
+      void shuffle(std::uint64_t seed);
+
+      bool empty() const;
+      std::size_t size() const;
+
+      template <typename Value>
+      class Iterator;
+
+      typedef Iterator<int> iterator;
+      typedef Iterator<const int> const_iterator;
+
+      // Iterate from the topmost card to the bottommost one.
+      iterator begin();
+      iterator end();
+      const_iterator begin() const;
+      const_iterator end() const;
+
+      // Calls f with the id of each card, starting from the first element.
+      template <typename F>
+      void for_each_top_to_bottom(F f) const;
+
+      // Calls f with the id of each card, starting from the last element.
+      template <typename F>
+      void for_each_bottom_to_top(F f) const;
+
+      // A dynamic data structure must have a destructor
+      // that can be called to deallocate memory,
+      // when the data structure is not needed any more.
+      ~List_storage();
+
+    private:
+      // The cards form a circular doubly linked list: the card below the
+      // bottom card is the top card again. This keeps adding, removing and
+      // both rotations constant time.
+      struct Card_data {
+        int data;
+        Card_data* next;
+        Card_data* prev;
+      };
+
+      Card_data* top_;
+      std::size_t size_;
+
+      // Cards are carved out of slabs that are owned by the deck. Removed
+      // cards go to a free list and are reused by later additions, so
+      // add/remove do not touch the heap once the deck has warmed up.
+      // Slabs double in size from FIRST_SLAB_SIZE up to MAX_SLAB_SIZE.
+      static const std::size_t FIRST_SLAB_SIZE = 32;
+      static const std::size_t MAX_SLAB_SIZE = 4096;
+
+      std::vector<Card_data*> slabs_;
+      Card_data* newest_slab_;
+      std::size_t slab_size_;
+      std::size_t slab_used_;
+      Card_data* free_list_;
+      Card_data* free_tail_;
+
+      Card_data* allocate_card(int id);
+      void release_card(Card_data* card);
+};
+
+
+// Bidirectional iterator over the cards of a List_storage. The list is
+// circular, so the end iterator points to the top card again and is told
+// apart from begin by its position.
+template <typename Value>
+class List_storage::Iterator {
+
+    public:
+      typedef std::bidirectional_iterator_tag iterator_category;
+      typedef int value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef Value* pointer;
+      typedef Value& reference;
+
+      Iterator(): card_(nullptr), position_(0)
+      {
+      }
+
+      // Converts an iterator to a const_iterator.
+      template <typename Other>
+      Iterator(const Iterator<Other>& other):
+          card_(other.card_), position_(other.position_)
+      {
+      }
+
+      reference operator*() const
+      {
+          return card_->data;
+      }
+
+      pointer operator->() const
+      {
+          return &card_->data;
+      }
+
+      Iterator& operator++()
+      {
+          card_ = card_->next;
+          ++position_;
+          return *this;
+      }
+
+      Iterator operator++(int)
+      {
+          Iterator old = *this;
+          ++*this;
+          return old;
+      }
+
+      Iterator& operator--()
+      {
+          card_ = card_->prev;
+          --position_;
+          return *this;
+      }
+
+      Iterator operator--(int)
+      {
+          Iterator old = *this;
+          --*this;
+          return old;
+      }
+
+      bool operator==(const Iterator& other) const
+      {
+          return position_ == other.position_;
+      }
+
+      bool operator!=(const Iterator& other) const
+      {
+          return position_ != other.position_;
+      }
+
+    private:
+      friend class List_storage;
+      template <typename Other>
+      friend class Iterator;
+
+      typedef typename std::conditional<std::is_const<Value>::value,
+                                        const Card_data, Card_data>::type Node;
+
+      Iterator(Node* card, std::size_t position):
+          card_(card), position_(position)
+      {
+      }
+
+      Node* card_;
+      std::size_t position_;
+};
+
+inline List_storage::iterator List_storage::begin()
+{
+    return iterator(top_, 0);
+}
+
+inline List_storage::iterator List_storage::end()
+{
+    return iterator(top_, size_);
+}
+
+inline List_storage::const_iterator List_storage::begin() const
+{
+    return const_iterator(top_, 0);
+}
+
+inline List_storage::const_iterator List_storage::end() const
+{
+    return const_iterator(top_, size_);
+}
+
+
+template <typename F>
+void List_storage::for_each_top_to_bottom(F f) const
+{
+    if ( top_ == nullptr ) {
+       return;
+    }
+
+    const Card_data* card = top_;
+    do {
+       f(card->data);
+       card = card->next;
+    } while ( card != top_ );
+}
+
+template <typename F>
+void List_storage::for_each_bottom_to_top(F f) const
+{
+    if ( top_ == nullptr ) {
+       return;
+    }
+
+    const Card_data* card = top_->prev;
+    do {
+       f(card->data);
+       card = card->prev;
+    } while ( card != top_->prev );
+}
+
+#endif // LIST_STORAGE_HH
@@ -0,0 +1,103 @@
+#include "mapped_file.hh"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+using namespace std;
+
+Mapped_file::Mapped_file(): data_(nullptr), size_(0)
+{
+}
+
+#ifdef MAPPED_FILE_MMAP
+
+bool Mapped_file::open(const string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if ( fd < 0 ) {
+       return false;
+    }
+
+    struct stat info;
+    if ( fstat(fd, &info) != 0 ) {
+       ::close(fd);
+       return false;
+    }
+
+    // An empty file cannot be mapped, but it is still a valid file.
+    size_t size = static_cast<size_t>(info.st_size);
+    if ( size != 0 ) {
+       void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+       if ( mapping == MAP_FAILED ) {
+          ::close(fd);
+          return false;
+       }
+       madvise(mapping, size, MADV_SEQUENTIAL);
+       data_ = static_cast<const char*>(mapping);
+    }
+    size_ = size;
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return true;
+}
+
+void Mapped_file::close()
+{
+    if ( data_ != nullptr ) {
+       munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#else
+
+bool Mapped_file::open(const string& path)
+{
+    close();
+
+    ifstream file(path, ios::binary);
+    if ( not file ) {
+       return false;
+    }
+    contents_.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    data_ = contents_.data();
+    size_ = contents_.size();
+    return true;
+}
+
+void Mapped_file::close()
+{
+    contents_.clear();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+const char* Mapped_file::data() const
+{
+    return data_;
+}
+
+size_t Mapped_file::size() const
+{
+    return size_;
+}
+
+// destructor
+Mapped_file::~Mapped_file()
+{
+    close();
+}
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_HH
+#define MAPPED_FILE_HH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is memory
+// mapped, so opening it does not copy anything; elsewhere the file is
+// read into memory.
+class Mapped_file {
+
+    public:
+      Mapped_file();
+
+      Mapped_file(const Mapped_file&) = delete;
+      Mapped_file& operator=(const Mapped_file&) = delete;
+
+      // Maps the file with the given path, releasing any earlier mapping.
+      // Returns false, if the file cannot be opened or mapped.
+      bool open(const std::string& path);
+
+      const char* data() const;
+      std::size_t size() const;
+
+      ~Mapped_file();
+
+    private:
+      const char* data_;
+      std::size_t size_;
+      std::vector<char> contents_;
+
+      void close();
+};
+
+#endif // MAPPED_FILE_HH
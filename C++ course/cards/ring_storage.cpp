@@ -0,0 +1,213 @@
+#include "ring_storage.hh"
+#include "shuffle.hh"
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+Ring_storage::Ring_storage(): top_(0), size_(0)
+{
+}
+
+Ring_storage::Ring_storage(Ring_storage&& other) noexcept:
+    Ring_storage()
+{
+    swap(other);
+}
+
+Ring_storage& Ring_storage::operator=(Ring_storage&& other) noexcept
+{
+    Ring_storage moved(std::move(other));
+    swap(moved);
+    return *this;
+}
+
+void Ring_storage::swap(Ring_storage& other) noexcept
+{
+    cards_.swap(other.cards_);
+    std::swap(top_, other.top_);
+    std::swap(size_, other.size_);
+}
+
+
+// Adds a new card with the given id as the topmost element.
+void Ring_storage::push_top(int id)
+{
+    reserve(size_ + 1);
+
+    top_ = (top_ - 1) & (cards_.size() - 1);
+    cards_[top_] = id;
+    ++size_;
+}
+
+bool Ring_storage::pop_top(int &id)
+{
+    // empty deck
+    if ( size_ == 0 ) {
+       return false;
+    }
+
+    id = cards_[top_];
+    top_ = index(1);
+    --size_;
+
+    return true;
+}
+
+// Moves the last element of the data structure as the first one.
+// Returns false, if the data structure is empty, otherwise returns true.
+// The bottom card is copied to the free slot above the top. When the
+// buffer is full, that slot is the bottom card itself.
+bool Ring_storage::rotate_bottom_to_top()
+{
+    // empty deck
+    if (size_ == 0)
+        return false;
+
+    size_t new_top = (top_ - 1) & (cards_.size() - 1);
+    cards_[new_top] = cards_[index(size_ - 1)];
+    top_ = new_top;
+    return true;
+}
+
+// Moves the first element of the data structure as the last one.
+// Returns false, if the data structure is empty, otherwise returns true.
+// The top card is copied to the free slot below the bottom. When the
+// buffer is full, that slot is the top card itself.
+bool Ring_storage::rotate_top_to_bottom()
+{
+    // empty deck
+    if (size_ == 0)
+        return false;
+
+    cards_[index(size_)] = cards_[top_];
+    top_ = index(1);
+    return true;
+}
+
+void Ring_storage::push_range(const int* first, const int* last)
+{
+    reserve(size_ + (last - first));
+
+    size_t mask = cards_.size() - 1;
+    for ( const int* id = first; id != last; ++id ) {
+       top_ = (top_ - 1) & mask;
+       cards_[top_] = *id;
+    }
+    size_ += last - first;
+}
+
+size_t Ring_storage::pop_range(size_t n, int* out)
+{
+    if ( n > size_ ) {
+       n = size_;
+    }
+
+    for ( size_t i = 0; i < n; ++i ) {
+       out[i] = cards_[index(i)];
+    }
+    if ( n != 0 ) {
+       top_ = index(n);
+       size_ -= n;
+    }
+    return n;
+}
+
+bool Ring_storage::rotate(ptrdiff_t k)
+{
+    // empty deck
+    if (size_ == 0)
+        return false;
+
+    ptrdiff_t n = static_cast<ptrdiff_t>(size_);
+    ptrdiff_t steps = k % n;
+    if ( steps < 0 ) {
+       steps += n;
+    }
+
+    size_t mask = cards_.size() - 1;
+    if ( size_ == cards_.size() ) {
+       top_ = index(steps);
+    } else if ( steps <= n / 2 ) {
+       // the topmost cards are copied below the bottom one by one
+       for ( ptrdiff_t i = 0; i < steps; ++i ) {
+          cards_[index(size_)] = cards_[top_];
+          top_ = index(1);
+       }
+    } else {
+       // the bottommost cards are copied above the top one by one
+       for ( ptrdiff_t i = steps; i < n; ++i ) {
+          size_t new_top = (top_ - 1) & mask;
+          cards_[new_top] = cards_[index(size_ - 1)];
+          top_ = new_top;
+       }
+    }
+    return true;
+}
+
+void Ring_storage::splice(Ring_storage& other)
+{
+    if ( &other == this or other.size_ == 0 ) {
+       return;
+    }
+
+    reserve(size_ + other.size_);
+
+    size_t mask = cards_.size() - 1;
+    other.for_each_bottom_to_top([&](int id) {
+        top_ = (top_ - 1) & mask;
+        cards_[top_] = id;
+    });
+    size_ += other.size_;
+
+    other.top_ = 0;
+    other.size_ = 0;
+}
+
+// If the cards wrap around the end of the buffer, they are first rotated
+// to start from index 0, so that they can be shuffled in place.
+void Ring_storage::shuffle(uint64_t seed)
+{
+    if ( top_ + size_ > cards_.size() ) {
+       std::rotate(cards_.begin(), cards_.begin() + top_, cards_.end());
+       top_ = 0;
+    }
+    shuffle_ids(cards_.data() + top_, size_, seed);
+}
+
+bool Ring_storage::empty() const
+{
+    return size_ == 0;
+}
+
+size_t Ring_storage::size() const
+{
+    return size_;
+}
+
+size_t Ring_storage::index(size_t depth) const
+{
+    return (top_ + depth) & (cards_.size() - 1);
+}
+
+void Ring_storage::reserve(size_t cards)
+{
+    if ( cards <= cards_.size() ) {
+       return;
+    }
+
+    size_t capacity = cards_.empty() ? FIRST_CAPACITY : cards_.size();
+    while ( capacity < cards ) {
+       capacity *= 2;
+    }
+
+    vector<int> bigger(capacity);
+    size_t i = 0;
+    for_each_top_to_bottom([&](int id) {
+        bigger[i] = id;
+        ++i;
+    });
+
+    cards_.swap(bigger);
+    top_ = 0;
+}
@@ -0,0 +1,309 @@
+#ifndef RING_STORAGE_HH
+#define RING_STORAGE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// Storage policy for Basic_cards that keeps the cards in one contiguous,
+// growable ring buffer. Traversal walks memory linearly, which is much
+// friendlier to the cache than following list pointers.
+class Ring_storage {
+
+    public:
+      Ring_storage();
+
+      // Copying duplicates the buffer; moving takes it over and leaves
+      // other empty.
+      Ring_storage(const Ring_storage& other) = default;
+      Ring_storage(Ring_storage&& other) noexcept;
+
+      Ring_storage& operator=(const Ring_storage& other) = default;
+      Ring_storage& operator=(Ring_storage&& other) noexcept;
+
+      void swap(Ring_storage& other) noexcept;
+
+      // Adds a new card with the given id as the topmost element.
+      void push_top(int id);
+
+      // Removes the topmost card and passes it in the reference parameter id to the caller.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool pop_top(int& id);
+
+      // Moves the last element of the data structure as the first one.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool rotate_bottom_to_top();
+
+      // Moves the first element of the data structure as the last one.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool rotate_top_to_bottom();
+
+      // Adds the ids from first to last one by one, so that the card
+      // pointed by last - 1 ends up as the topmost element.
+      void push_range(const int* first, const int* last);
+
+      // Removes at most n topmost cards, writing them to out in the order
+      // they were removed. Returns the amount of cards removed.
+      std::size_t pop_range(std::size_t n, int* out);
+
+      // Moves k cards from the top to the bottom, or -k cards from the
+      // bottom to the top when k is negative. A full buffer only moves the
+      // top index; otherwise at most half of the deck is copied once.
+      // Returns false, if the data structure is empty, otherwise returns true.
+      bool rotate(std::ptrdiff_t k);
+
+      // Moves all the cards of other on top of this deck, keeping their
+      // order, and leaves other empty. The cards of other are copied, so
+      // this is linear in the size of other.
+      void splice(Ring_storage& other);
+
+      // Puts the cards in a uniformly random order that depends only on
+      // the seed and the amount of cards.
+      void shuffle(std::uint64_t seed);
+
+      bool empty() const;
+      std::size_t size() const;
+
+      template <typename Value>
+      class Iterator;
+
+      typedef Iterator<int> iterator;
+      typedef Iterator<const int> const_iterator;
+
+      // Iterate from the topmost card to the bottommost one.
+      iterator begin();
+      iterator end();
+      const_iterator begin() const;
+      const_iterator end() const;
+
+      // Calls f with the id of each card, starting from the first element.
+      template <typename F>
+      void for_each_top_to_bottom(F f) const;
+
+      // Calls f with the id of each card, starting from the last element.
+      template <typename F>
+      void for_each_bottom_to_top(F f) const;
+
+    private:
+      // The capacity of the buffer is always a power of two, so that
+      // positions wrap around with a mask instead of a division.
+      static const std::size_t FIRST_CAPACITY = 16;
+
+      std::vector<int> cards_;
+      std::size_t top_;
+      std::size_t size_;
+
+      // Returns the buffer index of the card at the given depth from the top.
+      std::size_t index(std::size_t depth) const;
+
+      // Grows the buffer to the smallest power of two that has room for the
+      // given amount of cards, laying the cards out from index 0 onwards.
+      void reserve(std::size_t cards);
+};
+
+
+// Random access iterator over the cards of a Ring_storage. It keeps the
+// depth of the card from the top and wraps it into the buffer on access.
+template <typename Value>
+class Ring_storage::Iterator {
+
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef int value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef Value* pointer;
+      typedef Value& reference;
+
+      Iterator(): cards_(nullptr), mask_(0), top_(0), depth_(0)
+      {
+      }
+
+      // Converts an iterator to a const_iterator.
+      template <typename Other>
+      Iterator(const Iterator<Other>& other):
+          cards_(other.cards_), mask_(other.mask_), top_(other.top_),
+          depth_(other.depth_)
+      {
+      }
+
+      reference operator*() const
+      {
+          return cards_[(top_ + depth_) & mask_];
+      }
+
+      pointer operator->() const
+      {
+          return &**this;
+      }
+
+      reference operator[](difference_type n) const
+      {
+          return *(*this + n);
+      }
+
+      Iterator& operator+=(difference_type n)
+      {
+          depth_ += n;
+          return *this;
+      }
+
+      Iterator& operator-=(difference_type n)
+      {
+          depth_ -= n;
+          return *this;
+      }
+
+      Iterator& operator++()
+      {
+          ++depth_;
+          return *this;
+      }
+
+      Iterator operator++(int)
+      {
+          Iterator old = *this;
+          ++depth_;
+          return old;
+      }
+
+      Iterator& operator--()
+      {
+          --depth_;
+          return *this;
+      }
+
+      Iterator operator--(int)
+      {
+          Iterator old = *this;
+          --depth_;
+          return old;
+      }
+
+      Iterator operator+(difference_type n) const
+      {
+          Iterator moved = *this;
+          moved.depth_ += n;
+          return moved;
+      }
+
+      friend Iterator operator+(difference_type n, const Iterator& it)
+      {
+          return it + n;
+      }
+
+      Iterator operator-(difference_type n) const
+      {
+          Iterator moved = *this;
+          moved.depth_ -= n;
+          return moved;
+      }
+
+      difference_type operator-(const Iterator& other) const
+      {
+          return static_cast<difference_type>(depth_ - other.depth_);
+      }
+
+      bool operator==(const Iterator& other) const
+      {
+          return depth_ == other.depth_;
+      }
+
+      bool operator!=(const Iterator& other) const
+      {
+          return depth_ != other.depth_;
+      }
+
+      bool operator<(const Iterator& other) const
+      {
+          return depth_ < other.depth_;
+      }
+
+      bool operator>(const Iterator& other) const
+      {
+          return depth_ > other.depth_;
+      }
+
+      bool operator<=(const Iterator& other) const
+      {
+          return depth_ <= other.depth_;
+      }
+
+      bool operator>=(const Iterator& other) const
+      {
+          return depth_ >= other.depth_;
+      }
+
+    private:
+      friend class Ring_storage;
+      template <typename Other>
+      friend class Iterator;
+
+      Iterator(Value* cards, std::size_t mask, std::size_t top,
+               std::size_t depth):
+          cards_(cards), mask_(mask), top_(top), depth_(depth)
+      {
+      }
+
+      Value* cards_;
+      std::size_t mask_;
+      std::size_t top_;
+      std::size_t depth_;
+};
+
+inline Ring_storage::iterator Ring_storage::begin()
+{
+    return iterator(cards_.data(), cards_.size() - 1, top_, 0);
+}
+
+inline Ring_storage::iterator Ring_storage::end()
+{
+    return iterator(cards_.data(), cards_.size() - 1, top_, size_);
+}
+
+inline Ring_storage::const_iterator Ring_storage::begin() const
+{
+    return const_iterator(cards_.data(), cards_.size() - 1, top_, 0);
+}
+
+inline Ring_storage::const_iterator Ring_storage::end() const
+{
+    return const_iterator(cards_.data(), cards_.size() - 1, top_, size_);
+}
+
+
+template <typename F>
+void Ring_storage::for_each_top_to_bottom(F f) const
+{
+    // The cards are at most two contiguous runs: from the top to the end
+    // of the buffer and from the start of the buffer to the bottom.
+    std::size_t first_run = cards_.size() - top_;
+    if ( first_run > size_ ) {
+       first_run = size_;
+    }
+
+    for ( std::size_t i = top_; i < top_ + first_run; ++i ) {
+       f(cards_[i]);
+    }
+    for ( std::size_t i = 0; i < size_ - first_run; ++i ) {
+       f(cards_[i]);
+    }
+}
+
+template <typename F>
+void Ring_storage::for_each_bottom_to_top(F f) const
+{
+    std::size_t first_run = cards_.size() - top_;
+    if ( first_run > size_ ) {
+       first_run = size_;
+    }
+
+    for ( std::size_t i = size_ - first_run; i > 0; --i ) {
+       f(cards_[i - 1]);
+    }
+    for ( std::size_t i = top_ + first_run; i > top_; --i ) {
+       f(cards_[i - 1]);
+    }
+}
+
+#endif // RING_STORAGE_HH
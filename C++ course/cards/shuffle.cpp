@@ -0,0 +1,162 @@
+#include "shuffle.hh"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// The large shuffle always uses this many input blocks and output
+// buckets, so that the result does not depend on the thread count.
+const size_t BUCKET_BITS = 8;
+const size_t BUCKETS = size_t(1) << BUCKET_BITS;
+
+// Derives an independent random number stream for each block and bucket
+// from the seed (the splitmix64 finalizer).
+mt19937_64 stream(uint64_t seed, uint64_t stream_number)
+{
+    uint64_t z = seed + (stream_number + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return mt19937_64(z ^ (z >> 31));
+}
+
+// Returns the high and low 64 bits of the product of a and b.
+uint64_t multiply(uint64_t a, uint64_t b, uint64_t& low)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    low = static_cast<uint64_t>(product);
+    return static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t a_low = a & 0xffffffff, a_high = a >> 32;
+    uint64_t b_low = b & 0xffffffff, b_high = b >> 32;
+    uint64_t low_low = a_low * b_low;
+    uint64_t middle = a_high * b_low + (low_low >> 32);
+    uint64_t middle2 = a_low * b_high + (middle & 0xffffffff);
+    low = (middle2 << 32) | (low_low & 0xffffffff);
+    return a_high * b_high + (middle >> 32) + (middle2 >> 32);
+#endif
+}
+
+// Draws a uniformly random number below bound with Lemire's multiply and
+// reject method. Unlike uniform_int_distribution, whose algorithm is up to
+// the standard library, it gives the same numbers everywhere, so the same
+// seed shuffles a deck the same way with every compiler.
+uint64_t below(uint64_t bound, mt19937_64& rng)
+{
+    uint64_t low = 0;
+    uint64_t high = multiply(rng(), bound, low);
+    if ( low < bound ) {
+       // Products whose low half is below 2^64 mod bound would make some
+       // results more likely than others.
+       uint64_t threshold = (0 - bound) % bound;
+       while ( low < threshold ) {
+          high = multiply(rng(), bound, low);
+       }
+    }
+    return high;
+}
+
+void fisher_yates(int* ids, size_t n, mt19937_64& rng)
+{
+    for ( size_t i = n; i > 1; --i ) {
+       swap(ids[i - 1], ids[below(i, rng)]);
+    }
+}
+
+// Calls f(0), ..., f(count - 1) on all cores.
+template <typename F>
+void parallel_for(size_t count, F f)
+{
+    size_t threads = max(1u, thread::hardware_concurrency());
+    atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        for ( size_t i = next++; i < count; i = next++ ) {
+           f(i);
+        }
+    };
+
+    vector<thread> helpers;
+    for ( size_t t = 1; t < min(threads, count); ++t ) {
+       helpers.emplace_back(worker);
+    }
+    worker();
+    for ( thread& helper : helpers ) {
+       helper.join();
+    }
+}
+
+void parallel_shuffle(int* ids, size_t n, uint64_t seed)
+{
+    size_t block_size = (n + BUCKETS - 1) / BUCKETS;
+    vector<unsigned char> bucket_of(n);
+    vector<size_t> counts(BUCKETS * BUCKETS);
+
+    // Every card picks a bucket at random.
+    parallel_for(BUCKETS, [&](size_t block) {
+        size_t first = min(n, block * block_size);
+        size_t last = min(n, first + block_size);
+        mt19937_64 rng = stream(seed, block);
+        size_t* block_counts = &counts[block * BUCKETS];
+
+        for ( size_t i = first; i < last; ++i ) {
+           unsigned char bucket = rng() >> (64 - BUCKET_BITS);
+           bucket_of[i] = bucket;
+           ++block_counts[bucket];
+        }
+    });
+
+    // Bucket b goes before bucket b + 1, and within a bucket the cards of
+    // block k go before the cards of block k + 1.
+    vector<size_t> offsets(BUCKETS * BUCKETS);
+    vector<size_t> bucket_start(BUCKETS + 1);
+    size_t offset = 0;
+    for ( size_t bucket = 0; bucket < BUCKETS; ++bucket ) {
+       bucket_start[bucket] = offset;
+       for ( size_t block = 0; block < BUCKETS; ++block ) {
+          offsets[block * BUCKETS + bucket] = offset;
+          offset += counts[block * BUCKETS + bucket];
+       }
+    }
+    bucket_start[BUCKETS] = n;
+
+    vector<int> scattered(n);
+    parallel_for(BUCKETS, [&](size_t block) {
+        size_t first = min(n, block * block_size);
+        size_t last = min(n, first + block_size);
+        size_t* block_offsets = &offsets[block * BUCKETS];
+
+        for ( size_t i = first; i < last; ++i ) {
+           scattered[block_offsets[bucket_of[i]]++] = ids[i];
+        }
+    });
+
+    // Shuffling each bucket makes the whole order uniformly random.
+    parallel_for(BUCKETS, [&](size_t bucket) {
+        size_t first = bucket_start[bucket];
+        size_t last = bucket_start[bucket + 1];
+        mt19937_64 rng = stream(seed, BUCKETS + bucket);
+
+        fisher_yates(&scattered[first], last - first, rng);
+        memcpy(ids + first, &scattered[first], (last - first) * sizeof(int));
+    });
+}
+
+}
+
+void shuffle_ids(int* ids, size_t n, uint64_t seed)
+{
+    if ( n < PARALLEL_SHUFFLE_THRESHOLD ) {
+       mt19937_64 rng = stream(seed, 0);
+       fisher_yates(ids, n, rng);
+    } else {
+       parallel_shuffle(ids, n, seed);
+    }
+}
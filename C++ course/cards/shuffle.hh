@@ -0,0 +1,20 @@
+#ifndef SHUFFLE_HH
+#define SHUFFLE_HH
+
+#include <cstddef>
+#include <cstdint>
+
+// Decks with at least this many cards are shuffled on all cores.
+const std::size_t PARALLEL_SHUFFLE_THRESHOLD = std::size_t(1) << 22;
+
+// Puts the n ids in a uniformly random order. The order depends only on
+// the seed and n, not on the amount of cores the shuffle runs on or on the
+// standard library: the random numbers come from mt19937_64, whose output
+// the standard fixes, and are bounded without the library's distributions.
+//
+// Small arrays are shuffled with Fisher-Yates. Large ones are first
+// scattered to buckets at random and each bucket is then shuffled with
+// Fisher-Yates; both phases are split across threads.
+void shuffle_ids(int* ids, std::size_t n, std::uint64_t seed);
+
+#endif // SHUFFLE_HH
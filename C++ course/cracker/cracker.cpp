@@ -0,0 +1,194 @@
+/* Cracker
+ *
+ * Scoring of keys and the annealing search.
+ */
+
+#include "cracker.hh"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+// Temperature at the start of a run for each trigram of the ciphertext. It
+// falls linearly to zero over the run.
+const double START_TEMPERATURE_PER_TRIGRAM = 0.1;
+
+// Derives an independent random number stream for each run from the seed
+// (the splitmix64 finalizer), so runs do not depend on the thread count.
+mt19937_64 stream(uint64_t seed, uint64_t stream_number) {
+    uint64_t z = seed + (stream_number + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return mt19937_64(z ^ (z >> 31));
+}
+
+}
+
+
+Cracker::Cracker(const Trigram_model& model, const string& ciphertext):
+    model_(model), trigram_count_(0) {
+    vector<unsigned int> counts(TRIGRAMS, 0);
+    int previous[2] = {0, 0};
+    size_t letters = 0;
+    for (char c : ciphertext) {
+        int letter = c - 'a';
+        if (letter < 0 || letter >= 26)
+            continue;
+        if (letters >= 2) {
+            ++counts[trigram_index(previous[0], previous[1], letter)];
+            ++trigram_count_;
+        }
+        previous[0] = previous[1];
+        previous[1] = letter;
+        ++letters;
+    }
+
+    for (size_t index = 0; index < TRIGRAMS; ++index) {
+        if (counts[index] == 0)
+            continue;
+        Trigram trigram;
+        trigram.letters[0] = static_cast<unsigned char>(index / 676);
+        trigram.letters[1] = static_cast<unsigned char>(index / 26 % 26);
+        trigram.letters[2] = static_cast<unsigned char>(index % 26);
+        trigram.letter_bits = 0;
+        for (unsigned char letter : trigram.letters)
+            trigram.letter_bits |= 1u << letter;
+        trigram.count = static_cast<float>(counts[index]);
+
+        for (int letter = 0; letter < 26; ++letter) {
+            if (trigram.letter_bits & (1u << letter))
+                with_letter_[letter].push_back(trigram);
+        }
+        trigrams_.push_back(trigram);
+    }
+}
+
+
+size_t Cracker::trigrams() const {
+    return trigram_count_;
+}
+
+
+double Cracker::score(const Decryption& decryption) const {
+    double score = 0;
+    for (const Trigram& trigram : trigrams_) {
+        size_t plain = trigram_index(decryption[trigram.letters[0]], decryption[trigram.letters[1]],
+                                     decryption[trigram.letters[2]]);
+        score += trigram.count * model_.log_probability(plain);
+    }
+    return score;
+}
+
+
+double Cracker::swap_delta(const Decryption& decryption, int first, int second) const {
+    Decryption swapped = decryption;
+    swap(swapped[first], swapped[second]);
+
+    float delta = 0;
+    for (const Trigram& trigram : with_letter_[first]) {
+        const unsigned char* t = trigram.letters;
+        size_t before = trigram_index(decryption[t[0]], decryption[t[1]], decryption[t[2]]);
+        size_t after = trigram_index(swapped[t[0]], swapped[t[1]], swapped[t[2]]);
+        delta += trigram.count * (model_.log_probability(after) - model_.log_probability(before));
+    }
+    // trigrams with both letters were already counted with the first one
+    const unsigned int first_bit = 1u << first;
+    for (const Trigram& trigram : with_letter_[second]) {
+        const unsigned char* t = trigram.letters;
+        size_t before = trigram_index(decryption[t[0]], decryption[t[1]], decryption[t[2]]);
+        size_t after = trigram_index(swapped[t[0]], swapped[t[1]], swapped[t[2]]);
+        float change = trigram.count * (model_.log_probability(after) - model_.log_probability(before));
+        delta += trigram.letter_bits & first_bit ? 0.0f : change;
+    }
+    return delta;
+}
+
+
+double Cracker::anneal(uint64_t seed, unsigned int iterations, Decryption& best) const {
+    mt19937_64 rng = stream(seed, 0);
+    uniform_int_distribution<int> letter(0, 25);
+    uniform_real_distribution<double> chance(0, 1);
+
+    Decryption decryption;
+    for (int i = 0; i < 26; ++i)
+        decryption[i] = i;
+    shuffle(decryption.begin(), decryption.end(), rng);
+
+    double current = score(decryption);
+    double best_score = current;
+    best = decryption;
+
+    const double start_temperature = START_TEMPERATURE_PER_TRIGRAM * trigram_count_;
+    for (unsigned int i = 0; i < iterations; ++i) {
+        int first = letter(rng);
+        int second = letter(rng);
+        if (first == second)
+            continue;
+
+        double delta = swap_delta(decryption, first, second);
+        double temperature = start_temperature * (iterations - i) / iterations;
+        if (delta >= 0 || chance(rng) < exp(delta / temperature)) {
+            swap(decryption[first], decryption[second]);
+            current += delta;
+            if (current > best_score) {
+                best_score = current;
+                best = decryption;
+            }
+        }
+    }
+    // The running sum drifts a little, so the best is scored once more.
+    return score(best);
+}
+
+
+Crack_result Cracker::crack(const Crack_options& options) const {
+    Crack_result result;
+    double best_score = -HUGE_VAL;
+    unsigned int best_run = 0;
+    mutex result_mutex;
+    atomic<unsigned int> next_run(0);
+
+    auto work = [&]() {
+        unsigned int run;
+        while ((run = next_run++) < options.restarts) {
+            Decryption decryption;
+            double run_score = anneal(stream(options.seed, run)(), options.iterations, decryption);
+
+            // Ties go to the earlier run, so the result does not depend on
+            // which thread finished first.
+            lock_guard<mutex> lock(result_mutex);
+            if (run_score > best_score || (run_score == best_score && run < best_run)) {
+                best_score = run_score;
+                best_run = run;
+                result.decryption = decryption;
+            }
+        }
+    };
+
+    vector<thread> helpers;
+    for (unsigned int t = 1; t < options.threads; ++t)
+        helpers.push_back(thread(work));
+    work();
+    for (thread& helper : helpers)
+        helper.join();
+
+    if (options.restarts == 0) {
+        for (int i = 0; i < 26; ++i)
+            result.decryption[i] = i;
+        best_score = score(result.decryption);
+    }
+
+    result.key.assign(26, 'a');
+    for (int cipher_letter = 0; cipher_letter < 26; ++cipher_letter)
+        result.key[result.decryption[cipher_letter]] = static_cast<char>('a' + cipher_letter);
+    result.score_per_trigram = trigram_count_ > 0 ? best_score / trigram_count_ : 0;
+    result.keys_tried = uint64_t(options.restarts) * options.iterations;
+    return result;
+}
@@ -0,0 +1,125 @@
+/* Cracker
+ *
+ * Recovery of the key of a text encrypted with the encryption program by
+ * simulated annealing: a candidate key is scored by the trigram statistics
+ * of the text it decrypts to, and two of its letters are swapped at a time.
+ * The ciphertext is reduced to the counts of its distinct trigrams, and a
+ * swap is scored only over the trigrams that contain either letter, so one
+ * try does not depend on the length of the text. Annealing runs from
+ * different random keys are spread over threads.
+ */
+
+#ifndef CRACKER_HH
+#define CRACKER_HH
+
+#include "trigram_model.hh"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// plaintext letter (0-25) of each ciphertext letter
+typedef array<int, 26> Decryption;
+
+
+struct Crack_options {
+    // amount of threads the runs are spread over
+    unsigned int threads = 1;
+
+    // amount of annealing runs, each from a different random key
+    unsigned int restarts = 16;
+
+    // amount of swaps tried in each run
+    unsigned int iterations = 20000;
+
+    // the result depends only on the seed, not on the amount of threads
+    uint64_t seed = 1;
+};
+
+
+struct Crack_result {
+    // encryption key in the form the encryption program takes
+    string key;
+
+    // decryption that the key is the inverse of
+    Decryption decryption;
+
+    // log probability of the decrypted text per trigram
+    double score_per_trigram = 0;
+
+    // amount of keys tried over all runs
+    uint64_t keys_tried = 0;
+};
+
+
+class Cracker {
+public:
+    /**
+     * @brief Cracker prepares the cracking of a ciphertext. Characters other
+     * than a-z are skipped.
+     * @param model language model, which must outlive the cracker
+     * @param ciphertext encrypted text
+     */
+    Cracker(const Trigram_model& model, const string& ciphertext);
+
+    /**
+     * @brief trigrams gives the amount of trigrams in the ciphertext
+     */
+    size_t trigrams() const;
+
+    /**
+     * @brief score scores a decryption by decrypting every trigram
+     * @param decryption decryption to be scored
+     * @return sum of the log probabilities of the decrypted trigrams
+     */
+    double score(const Decryption& decryption) const;
+
+    /**
+     * @brief swap_delta finds how the score changes if the plaintext letters
+     * of two ciphertext letters are swapped, going through only the
+     * trigrams that contain either of them
+     * @param decryption decryption before the swap
+     * @param first ciphertext letter 0-25
+     * @param second another ciphertext letter 0-25
+     * @return score after the swap minus score before it
+     */
+    double swap_delta(const Decryption& decryption, int first, int second) const;
+
+    /**
+     * @brief crack searches for the key with the best score
+     * @param options search options
+     * @return best key found
+     */
+    Crack_result crack(const Crack_options& options) const;
+
+private:
+    // A distinct trigram of the ciphertext and how many times it occurs.
+    struct Trigram {
+        unsigned char letters[3];
+        unsigned int letter_bits;
+        float count;
+    };
+
+    /**
+     * @brief anneal runs one annealing run from a random key
+     * @param seed seed of the run
+     * @param iterations amount of swaps tried
+     * @param best set to the best decryption of the run
+     * @return score of the best decryption
+     */
+    double anneal(uint64_t seed, unsigned int iterations, Decryption& best) const;
+
+    const Trigram_model& model_;
+    vector<Trigram> trigrams_;
+
+    // copies of the distinct trigrams that contain each letter, so that a
+    // swap reads two arrays from start to end
+    vector<Trigram> with_letter_[26];
+
+    size_t trigram_count_;
+};
+
+#endif // CRACKER_HH
@@ -0,0 +1,13 @@
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += \
+        cracker.cpp \
+        main.cpp \
+        trigram_model.cpp
+
+HEADERS += \
+    cracker.hh \
+    trigram_model.hh
@@ -0,0 +1,98 @@
+/* Cracker
+*
+* Recovers the key of a text encrypted with the encryption program, given a corpus of
+* the language of the text to learn its trigram statistics from:
+*     cracker --train CORPUS [--threads N] [--restarts R] [--iterations I] [--seed S] [FILE|-]
+* The ciphertext is read from FILE or standard input. The recovered key, in the form the
+* encryption program takes, is printed on the first line and the decrypted text after it.
+* Letters that do not occur in the ciphertext cannot be recovered, so short texts give
+* partly wrong keys that still decrypt the text.
+*/
+
+#include "cracker.hh"
+#include "trigram_model.hh"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+
+/**
+ * @brief print_usage prints the command line usage to cerr
+ * @param program name of the program
+ */
+void print_usage(const char* program)
+{
+    cerr << "Usage: " << program << " --train CORPUS [--threads N] [--restarts R]"
+         << " [--iterations I] [--seed S] [FILE|-]" << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    string corpus;
+    string path = "-";
+    bool has_path = false;
+    Crack_options options;
+    options.threads = max(1u, thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        bool has_value = i + 1 < argc;
+        if (argument == "--train" && has_value) {
+            corpus = argv[++i];
+        } else if (argument == "--threads" && has_value) {
+            options.threads = max(1ul, strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--restarts" && has_value) {
+            options.restarts = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--iterations" && has_value) {
+            options.iterations = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--seed" && has_value) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (!has_path && (argument == "-" || argument.compare(0, 1, "-") != 0)) {
+            path = argument;
+            has_path = true;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (corpus.empty()) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Trigram_model model;
+    if (!model.train_file(corpus))
+        return EXIT_FAILURE;
+
+    string ciphertext;
+    if (path == "-") {
+        ciphertext.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+    } else {
+        ifstream file(path, ios::binary);
+        if (!file) {
+            cerr << "Error! Cannot open " << path << "." << endl;
+            return EXIT_FAILURE;
+        }
+        ciphertext.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+
+    Cracker cracker(model, ciphertext);
+    Crack_result result = cracker.crack(options);
+
+    string plaintext = ciphertext;
+    for (char& c : plaintext) {
+        if (c >= 'a' && c <= 'z')
+            c = static_cast<char>('a' + result.decryption[c - 'a']);
+    }
+    cout << "Key: " << result.key << endl << plaintext;
+    if (!plaintext.empty() && plaintext.back() != '\n')
+        cout << endl;
+    return EXIT_SUCCESS;
+}
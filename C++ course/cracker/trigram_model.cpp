@@ -0,0 +1,63 @@
+/* Trigram model
+ *
+ * Training of the trigram log probabilities.
+ */
+
+#include "trigram_model.hh"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace std;
+
+
+Trigram_model::Trigram_model():
+    log_probabilities_(TRIGRAMS, static_cast<float>(-log(double(TRIGRAMS)))), letters_(0) {
+}
+
+
+void Trigram_model::train(const string& text) {
+    vector<size_t> counts(TRIGRAMS, 0);
+    size_t trigrams = 0;
+    int previous[2] = {0, 0};
+    letters_ = 0;
+    for (char c : text) {
+        int letter = c >= 'A' && c <= 'Z' ? c - 'A' : c - 'a';
+        if (letter < 0 || letter >= 26)
+            continue;
+        if (letters_ >= 2) {
+            ++counts[trigram_index(previous[0], previous[1], letter)];
+            ++trigrams;
+        }
+        previous[0] = previous[1];
+        previous[1] = letter;
+        ++letters_;
+    }
+
+    // add-one smoothing
+    double total = double(trigrams + TRIGRAMS);
+    for (size_t i = 0; i < TRIGRAMS; ++i)
+        log_probabilities_[i] = static_cast<float>(log((counts[i] + 1) / total));
+}
+
+
+bool Trigram_model::train_file(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file) {
+        cerr << "Error! Cannot open " << path << "." << endl;
+        return false;
+    }
+    string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (file.bad()) {
+        cerr << "Error! Reading " << path << " failed." << endl;
+        return false;
+    }
+    train(text);
+    return true;
+}
+
+
+size_t Trigram_model::letters() const {
+    return letters_;
+}
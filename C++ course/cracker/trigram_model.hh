@@ -0,0 +1,72 @@
+/* Trigram model
+ *
+ * Language model for scoring decrypted text: the log probability of every
+ * trigram of letters a-z, trained from a corpus. Characters other than
+ * letters are skipped, like the encryption program drops them, so trigrams
+ * run over word boundaries.
+ */
+
+#ifndef TRIGRAM_MODEL_HH
+#define TRIGRAM_MODEL_HH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// amount of different trigrams of letters a-z
+const size_t TRIGRAMS = 26 * 26 * 26;
+
+
+/**
+ * @brief trigram_index gives the index of a trigram of letters 0-25
+ */
+inline size_t trigram_index(int first, int second, int third) {
+    return (static_cast<size_t>(first) * 26 + second) * 26 + third;
+}
+
+
+class Trigram_model {
+public:
+    /**
+     * @brief Trigram_model creates a model where every trigram is equally probable
+     */
+    Trigram_model();
+
+    /**
+     * @brief train trains the model from a text, replacing earlier training.
+     * Uppercase letters count as lowercase. Trigrams that do not occur get
+     * the probability of one occurrence.
+     * @param text corpus
+     */
+    void train(const string& text);
+
+    /**
+     * @brief train_file trains the model from a file like train. Errors are
+     * printed to cerr.
+     * @param path corpus file
+     * @return False if the file cannot be read
+     */
+    bool train_file(const string& path);
+
+    /**
+     * @brief log_probability gives the natural logarithm of the probability of a trigram
+     * @param index trigram index from trigram_index
+     */
+    float log_probability(size_t index) const {
+        return log_probabilities_[index];
+    }
+
+    /**
+     * @brief letters gives the amount of letters the model was trained with
+     */
+    size_t letters() const;
+
+private:
+    vector<float> log_probabilities_;
+    size_t letters_;
+};
+
+#endif // TRIGRAM_MODEL_HH
@@ -0,0 +1,91 @@
+/* Cipher
+ *
+ * Substitution cipher with a compiled key or sequence of keys.
+ */
+
+#include "cipher.hh"
+#include "encryption.hh"
+
+using namespace std;
+
+
+Cipher::Cipher():
+    passthrough_(false) {
+    compile();
+}
+
+
+bool Cipher::set_key(const string& key) {
+    return set_keys(vector<string>{key});
+}
+
+
+bool Cipher::set_keys(const vector<string>& keys) {
+    if (keys.empty())
+        return false;
+    for (const string& key : keys) {
+        if (!check_key_validity(key))
+            return false;
+    }
+
+    keys_ = keys;
+    compile();
+    return true;
+}
+
+
+void Cipher::set_passthrough(bool passthrough) {
+    passthrough_ = passthrough;
+    compile();
+}
+
+
+size_t Cipher::key_count() const {
+    return keys_.size();
+}
+
+
+string Cipher::encrypt(const string& str) const {
+    string encrypted_string(str.length(), '\0');
+    encrypted_string.resize(encrypt(str.data(), str.length(), &encrypted_string[0]));
+    return encrypted_string;
+}
+
+
+size_t Cipher::encrypt(const char* in, size_t n, char* out, size_t position) const {
+    if (keys_.size() > 1)
+        return substitute(sequence_, position, in, n, out);
+    return substitute(tables_, in, n, out);
+}
+
+
+string Cipher::decrypt(const string& str) const {
+    string decrypted_string(str.length(), '\0');
+    decrypted_string.resize(decrypt(str.data(), str.length(), &decrypted_string[0]));
+    return decrypted_string;
+}
+
+
+size_t Cipher::decrypt(const char* in, size_t n, char* out, size_t position) const {
+    if (keys_.size() > 1)
+        return substitute(inverse_sequence_, position, in, n, out);
+    return substitute(inverse_tables_, in, n, out);
+}
+
+
+void Cipher::compile() {
+    vector<string> inverse_keys;
+    for (const string& key : keys_)
+        inverse_keys.push_back(invert_key(key));
+
+    if (keys_.size() > 1) {
+        compile_key_sequence(sequence_, keys_, passthrough_);
+        compile_key_sequence(inverse_sequence_, inverse_keys, passthrough_);
+        return;
+    }
+    // Without a key both tables are compiled from an empty key.
+    string key = keys_.empty() ? "" : keys_.front();
+    string inverse_key = inverse_keys.empty() ? "" : inverse_keys.front();
+    compile_substitution(tables_, key.data(), key.length(), passthrough_);
+    compile_substitution(inverse_tables_, inverse_key.data(), inverse_key.length(), passthrough_);
+}
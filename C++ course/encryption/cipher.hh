@@ -0,0 +1,112 @@
+/* Cipher
+ *
+ * Substitution cipher with a compiled key, or with a sequence of keys that
+ * rotate letter by letter like in a Vigenere cipher. The keys
+ * are validated and turned into lookup tables once, together with their
+ * inverses, after which any number of texts can be encrypted and decrypted
+ * with the fastest substitution kernel of the CPU.
+ */
+
+#ifndef CIPHER_HH
+#define CIPHER_HH
+
+#include "substitution.hh"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+class Cipher {
+public:
+    /**
+     * @brief Cipher creates a cipher without a key; it drops every character
+     */
+    Cipher();
+
+    /**
+     * @brief set_key validates a key like check_key_validity and compiles it
+     * and its inverse into the lookup tables
+     * @param key encryption key to be used
+     * @return True if the key was valid and taken into use, False if invalid
+     */
+    bool set_key(const string& key);
+
+    /**
+     * @brief set_keys validates a sequence of keys like check_key_validity and
+     * compiles them and their inverses into the lookup tables. Letter i of a
+     * text is encrypted with key i % keys.
+     * @param keys encryption keys to be used, at least one
+     * @return True if all the keys were valid and taken into use, False if
+     * any was invalid or there were none
+     */
+    bool set_keys(const vector<string>& keys);
+
+    /**
+     * @brief set_passthrough chooses whether characters other than a-z are
+     * passed through unchanged instead of being dropped. A cipher without a
+     * key still drops every character.
+     * @param passthrough True to pass through, False to drop (the default)
+     */
+    void set_passthrough(bool passthrough);
+
+    /**
+     * @brief key_count gives the amount of keys in the sequence
+     * @return amount of keys, 0 for a cipher without a key
+     */
+    size_t key_count() const;
+
+    /**
+     * @brief encrypt encrypts a string the same way as the function encrypt:
+     * letters a-z are substituted and all other characters are dropped,
+     * unless they are passed through
+     * @param str string to be encrypted
+     * @return encrypted string
+     */
+    string encrypt(const string& str) const;
+
+    /**
+     * @brief encrypt encrypts n characters from in to out, which must have
+     * room for n characters. The same buffer may be given as in and out.
+     * @param in characters to be encrypted
+     * @param n amount of characters
+     * @param out buffer for the encrypted characters
+     * @param position amount of letters a-z before in in the whole text,
+     * which picks the key of the first letter in a sequence of keys
+     * @return amount of characters written to out
+     */
+    size_t encrypt(const char* in, size_t n, char* out, size_t position = 0) const;
+
+    /**
+     * @brief decrypt decrypts a string encrypted with the same key. Characters
+     * other than a-z are dropped or passed through like when encrypting.
+     * @param str string to be decrypted
+     * @return decrypted string
+     */
+    string decrypt(const string& str) const;
+
+    /**
+     * @brief decrypt decrypts n characters from in to out like encrypt
+     * @param in characters to be decrypted
+     * @param n amount of characters
+     * @param out buffer for the decrypted characters
+     * @param position amount of letters a-z before in in the whole text
+     * @return amount of characters written to out
+     */
+    size_t decrypt(const char* in, size_t n, char* out, size_t position = 0) const;
+
+private:
+    // compiles the keys and their inverses into the tables, or into the
+    // sequence tables for more than one key
+    void compile();
+
+    vector<string> keys_;
+    bool passthrough_;
+    Substitution_tables tables_;
+    Substitution_tables inverse_tables_;
+    Key_sequence_tables sequence_;
+    Key_sequence_tables inverse_sequence_;
+};
+
+#endif // CIPHER_HH
@@ -0,0 +1,104 @@
+/* Encryption
+ *
+ * Checking of encryption keys and encryption of strings with a key or with a
+ * sequence of keys.
+ */
+
+#include "encryption.hh"
+#include <cctype>
+#include <iostream>
+
+using namespace std;
+
+
+bool check_if_lowercase(const string& str) {
+    for (char c : str) {
+        if (!islower(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+const char* key_error(const string& key) {
+    // key length
+    if (key.length() != 26)
+        return "Error! The encryption key must contain 26 characters.";
+
+    // Each letter sets its own bit, so 26 lowercase letters that set all 26
+    // bits contain the whole anglican alphabet without duplicates. The loop
+    // has no branches.
+    bool lowercase = true;
+    unsigned int letters = 0;
+    for (char c : key) {
+        unsigned int letter = static_cast<unsigned char>(c) - 'a';
+        lowercase &= letter < 26;
+        letters |= 1u << (letter & 31);
+    }
+
+    // lowercase anglican alphabet
+    if (!lowercase)
+        return "Error! The encryption key must contain lower case characters only.";
+
+    // contains all anglican letters = has no duplicate letters
+    if (letters != (1u << 26) - 1)
+        return "Error! The encryption key must contain all alphabets a-z.";
+    return nullptr;
+}
+
+
+size_t validate_keys(const vector<string>& keys, vector<bool>& valid) {
+    valid.resize(keys.size());
+    size_t valid_keys = 0;
+    for (vector<string>::size_type i = 0; i < keys.size(); ++i) {
+        valid[i] = key_error(keys[i]) == nullptr;
+        valid_keys += valid[i];
+    }
+    return valid_keys;
+}
+
+
+bool check_key_validity(const string& key) {
+    const char* error = key_error(key);
+    if (error != nullptr) {
+        cout << error << endl;
+        return false;
+    }
+    return true;
+}
+
+
+string encrypt(string str, string key) {
+    string encrypted_string = "";
+    string alphabets = "abcdefghijklmnopqrstuvwxyz";
+    for (char c : str) {
+        for (string::size_type i = 0; i < alphabets.length(); ++i) {
+            if (c == alphabets[i]) {
+                encrypted_string += key[i];
+            }
+        }
+    }
+    return encrypted_string;
+}
+
+
+string encrypt_with_keys(const string& str, const vector<string>& keys) {
+    // Only letters are encrypted, and only they move the keys on.
+    string encrypted_string = "";
+    string::size_type letters = 0;
+    for (char c : str) {
+        string encrypted = encrypt(string(1, c), keys[letters % keys.size()]);
+        encrypted_string += encrypted;
+        letters += encrypted.length();
+    }
+    return encrypted_string;
+}
+
+
+string invert_key(const string& key) {
+    string inverse(key.length(), '\0');
+    for (string::size_type i = 0; i < key.length(); ++i)
+        inverse[key[i] - 'a'] = static_cast<char>('a' + i);
+    return inverse;
+}
@@ -0,0 +1,79 @@
+/* Encryption
+ *
+ * Checking of encryption keys, one at a time or in batches, inverting keys
+ * for decryption and encryption of strings with a key or with a sequence of
+ * keys.
+ */
+
+#ifndef ENCRYPTION_HH
+#define ENCRYPTION_HH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * @brief check_if_lowercase checks if all the letters of a given string are lowercase anglican letters
+ * @param str string to be checked
+ * @return True if all lowercase, False if non-lowercase found
+ */
+bool check_if_lowercase(const string& str);
+
+
+/**
+ * @brief key_error finds what is wrong with an encryption key in a single
+ * pass over it
+ * @param key key to be checked
+ * @return error message for an invalid key, or nullptr for a valid key
+ */
+const char* key_error(const string& key);
+
+
+/**
+ * @brief validate_keys checks a batch of encryption keys without printing anything
+ * @param keys keys to be checked
+ * @param valid set to the validity of each key, in the same order
+ * @return amount of valid keys
+ */
+size_t validate_keys(const vector<string>& keys, vector<bool>& valid);
+
+
+/**
+ * @brief check_key_validity checks if an encryption key is valid (all anglican lowercase, 
+ * with 26 non-duplicate letters only) and prints the error of an invalid key
+ * @param key key to be checked
+ * @return True if valid, False if invalid
+ */
+bool check_key_validity(const string& key);
+
+
+/**
+ * @brief encrypt encrypts a string
+ * @param str string to be encrypted
+ * @param key encryption key to be used
+ * @return encrypted string
+ */
+string encrypt(string str, string key);
+
+
+/**
+ * @brief encrypt_with_keys encrypts a string polyalphabetically like a Vigenere
+ * cipher: letter i of the string is encrypted like with encrypt with key i % keys
+ * @param str string to be encrypted
+ * @param keys encryption keys to be used, at least one
+ * @return encrypted string
+ */
+string encrypt_with_keys(const string& str, const vector<string>& keys);
+
+
+/**
+ * @brief invert_key gives the key that decrypts what a key encrypts
+ * @param key valid encryption key
+ * @return inverse key, which maps every letter of key back to its place in the alphabet
+ */
+string invert_key(const string& key);
+
+#endif // ENCRYPTION_HH
@@ -1,7 +1,22 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++14 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
-        main.cpp
+        cipher.cpp \
+        encryption.cpp \
+        file_encryption.cpp \
+        framing.cpp \
+        main.cpp \
+        stream.cpp \
+        substitution.cpp
+
+HEADERS += \
+    cipher.hh \
+    encryption.hh \
+    file_encryption.hh \
+    fixed_cipher.hh \
+    framing.hh \
+    stream.hh \
+    substitution.hh
@@ -0,0 +1,168 @@
+/* File encryption
+ *
+ * Encryption of files on disk through memory mappings.
+ */
+
+#include "file_encryption.hh"
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FILE_ENCRYPTION_MMAP 1
+#endif
+
+using namespace std;
+
+#ifdef FILE_ENCRYPTION_MMAP
+
+namespace {
+
+/**
+ * @brief map_file maps size bytes of an open file, shared so that writes go
+ * to the file, and hints that the pages are used in order
+ * @return the mapping, or nullptr if it failed
+ */
+char* map_file(int fd, size_t size, bool writable) {
+    int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* mapping = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    return static_cast<char*>(mapping);
+}
+
+/**
+ * @brief file_size finds the size of an open file
+ * @return False if the size cannot be found
+ */
+bool file_size(int fd, size_t& size) {
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+        return false;
+    size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+/**
+ * @brief allocate_file sets the size of an open file and, where possible,
+ * allocates its blocks at once instead of on the first write to each page
+ * @return False if the size cannot be set
+ */
+bool allocate_file(int fd, size_t size) {
+#ifdef __linux__
+    if (size != 0 && posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0)
+        return true;
+#endif
+    return ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
+bool same_file(const string& first, const string& second) {
+    struct stat first_info;
+    struct stat second_info;
+    return stat(first.c_str(), &first_info) == 0 && stat(second.c_str(), &second_info) == 0
+           && first_info.st_dev == second_info.st_dev && first_info.st_ino == second_info.st_ino;
+}
+
+}
+
+
+bool encrypt_file_in_place(const Cipher& cipher, const string& path) {
+    int fd = open(path.c_str(), O_RDWR);
+    size_t size = 0;
+    if (fd < 0 || !file_size(fd, size)) {
+        cerr << "Error! Cannot open " << path << "." << endl;
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+
+    // An empty file cannot be mapped, and there is nothing to encrypt.
+    size_t written = 0;
+    if (size != 0) {
+        char* data = map_file(fd, size, true);
+        if (data == nullptr) {
+            cerr << "Error! Cannot map " << path << "." << endl;
+            close(fd);
+            return false;
+        }
+        written = cipher.encrypt(data, size, data);
+        munmap(data, size);
+    }
+
+    bool ok = written == size || ftruncate(fd, static_cast<off_t>(written)) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok)
+        cerr << "Error! Writing the encrypted text failed." << endl;
+    return ok;
+}
+
+
+bool encrypt_file_to(const Cipher& cipher, const string& in_path, const string& out_path) {
+    // Opening the output would truncate the input.
+    if (same_file(in_path, out_path))
+        return encrypt_file_in_place(cipher, in_path);
+
+    int in = open(in_path.c_str(), O_RDONLY);
+    size_t size = 0;
+    if (in < 0 || !file_size(in, size)) {
+        cerr << "Error! Cannot open " << in_path << "." << endl;
+        if (in >= 0)
+            close(in);
+        return false;
+    }
+
+    // The output gets the size of the input, which is enough for the
+    // encrypted text, and is shortened afterwards if characters are dropped.
+    int out = open(out_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (out < 0 || !allocate_file(out, size)) {
+        cerr << "Error! Cannot create " << out_path << "." << endl;
+        if (out >= 0)
+            close(out);
+        close(in);
+        return false;
+    }
+
+    size_t written = 0;
+    if (size != 0) {
+        char* in_data = map_file(in, size, false);
+        char* out_data = map_file(out, size, true);
+        if (in_data == nullptr || out_data == nullptr) {
+            cerr << "Error! Cannot map " << (in_data == nullptr ? in_path : out_path) << "." << endl;
+            if (in_data != nullptr)
+                munmap(in_data, size);
+            if (out_data != nullptr)
+                munmap(out_data, size);
+            close(in);
+            close(out);
+            return false;
+        }
+        written = cipher.encrypt(in_data, size, out_data);
+        munmap(in_data, size);
+        munmap(out_data, size);
+    }
+    close(in);
+
+    bool ok = written == size || ftruncate(out, static_cast<off_t>(written)) == 0;
+    ok = close(out) == 0 && ok;
+    if (!ok)
+        cerr << "Error! Writing the encrypted text failed." << endl;
+    return ok;
+}
+
+#else
+
+bool encrypt_file_in_place(const Cipher&, const string&) {
+    cerr << "Error! Mapped files are not supported on this system." << endl;
+    return false;
+}
+
+
+bool encrypt_file_to(const Cipher&, const string&, const string&) {
+    cerr << "Error! Mapped files are not supported on this system." << endl;
+    return false;
+}
+
+#endif
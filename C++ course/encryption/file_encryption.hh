@@ -0,0 +1,40 @@
+/* File encryption
+ *
+ * Encryption of files on disk through memory mappings: the cipher is run
+ * directly over the mapped pages, so no characters are copied through
+ * buffers in the program. Only available on POSIX systems; elsewhere the
+ * functions print an error and fail.
+ */
+
+#ifndef FILE_ENCRYPTION_HH
+#define FILE_ENCRYPTION_HH
+
+#include "cipher.hh"
+#include <string>
+
+using namespace std;
+
+
+/**
+ * @brief encrypt_file_in_place encrypts a file over itself. When characters
+ * are dropped, the file is shortened to the encrypted text. Errors are
+ * printed to cerr.
+ * @param cipher cipher with a key
+ * @param path file to be encrypted
+ * @return True if the file was encrypted, False on an error
+ */
+bool encrypt_file_in_place(const Cipher& cipher, const string& path);
+
+
+/**
+ * @brief encrypt_file_to encrypts a file into another file, which is created
+ * or replaced. Giving the same file twice encrypts it in place. Errors are
+ * printed to cerr.
+ * @param cipher cipher with a key
+ * @param in_path file to be encrypted
+ * @param out_path file for the encrypted text
+ * @return True if the file was encrypted, False on an error
+ */
+bool encrypt_file_to(const Cipher& cipher, const string& in_path, const string& out_path);
+
+#endif // FILE_ENCRYPTION_HH
@@ -0,0 +1,122 @@
+/* Fixed cipher
+ *
+ * Substitution cipher for a key that is known at compile time. The key is
+ * checked at compile time like check_key_validity checks it at run time,
+ * so an invalid key does not compile, and its lookup tables are constants:
+ * encrypting needs no setup at run time and goes through the same
+ * substitution kernels as Cipher.
+ *
+ *     constexpr char KEY[] = "qwertyuiopasdfghjklzxcvbnm";
+ *     string encrypted = Fixed_cipher<KEY>::encrypt(text);
+ */
+
+#ifndef FIXED_CIPHER_HH
+#define FIXED_CIPHER_HH
+
+#include "substitution.hh"
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+
+/**
+ * @brief fixed_key_length gives the length of a key known at compile time
+ */
+constexpr size_t fixed_key_length(const char* key) {
+    size_t length = 0;
+    while (key[length] != '\0')
+        ++length;
+    return length;
+}
+
+
+/**
+ * @brief fixed_key_lowercase checks if a key known at compile time has only
+ * lowercase anglican letters
+ */
+constexpr bool fixed_key_lowercase(const char* key) {
+    for (size_t i = 0; key[i] != '\0'; ++i) {
+        if (key[i] < 'a' || key[i] > 'z')
+            return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief fixed_key_all_letters checks if a key known at compile time has
+ * every anglican letter, and so no duplicates if it has 26 letters
+ */
+constexpr bool fixed_key_all_letters(const char* key) {
+    if (!fixed_key_lowercase(key))
+        return false;
+    unsigned int letters = 0;
+    for (size_t i = 0; key[i] != '\0'; ++i)
+        letters |= 1u << (key[i] - 'a');
+    return letters == (1u << 26) - 1;
+}
+
+
+/**
+ * @brief make_fixed_tables compiles a valid key into lookup tables at compile
+ * time, like compile_substitution does at run time
+ */
+constexpr Substitution_tables make_fixed_tables(const char* key) {
+    Substitution_tables tables = {};
+    for (size_t i = 0; i < 26 && key[i] != '\0'; ++i) {
+        tables.table['a' + i] = key[i];
+        tables.by_low_bits[('a' + i) & 63] = key[i];
+        if (i < 16)
+            tables.first_half[i] = key[i];
+        else
+            tables.second_half[i - 16] = key[i];
+    }
+    tables.has_key = true;
+    return tables;
+}
+
+
+template <const char* KEY>
+class Fixed_cipher {
+    static_assert(fixed_key_length(KEY) == 26,
+                  "Error! The encryption key must contain 26 characters.");
+    static_assert(fixed_key_lowercase(KEY),
+                  "Error! The encryption key must contain lower case characters only.");
+    static_assert(fixed_key_all_letters(KEY),
+                  "Error! The encryption key must contain all alphabets a-z.");
+
+public:
+    static constexpr Substitution_tables TABLES = make_fixed_tables(KEY);
+
+    /**
+     * @brief encrypt encrypts one character, at compile time if it is a constant
+     * @return substitute of the character, or 0 if it is dropped
+     */
+    static constexpr char encrypt(char c) {
+        return TABLES.table[static_cast<unsigned char>(c)];
+    }
+
+    /**
+     * @brief encrypt encrypts n characters from in to out the same way as the
+     * function encrypt. The same buffer may be given as in and out.
+     * @return amount of characters written to out
+     */
+    static size_t encrypt(const char* in, size_t n, char* out) {
+        return substitute(TABLES, in, n, out);
+    }
+
+    /**
+     * @brief encrypt encrypts a string the same way as the function encrypt
+     */
+    static string encrypt(const string& str) {
+        string encrypted_string(str.length(), '\0');
+        encrypted_string.resize(encrypt(str.data(), str.length(), &encrypted_string[0]));
+        return encrypted_string;
+    }
+};
+
+template <const char* KEY>
+constexpr Substitution_tables Fixed_cipher<KEY>::TABLES;
+
+#endif // FIXED_CIPHER_HH
@@ -0,0 +1,357 @@
+/* Framing
+ *
+ * CRC32C checksums, frame headers and the verifier of framed texts.
+ */
+
+#include "framing.hh"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRAMING_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = {'S', 'U', 'B', 'F', 'R', 'A', 'M', 'E'};
+const uint32_t VERSION = 1;
+
+// largest maximum payload accepted by the verifier, so that a corrupted
+// stream header cannot make it allocate without bound
+const size_t MAX_FRAME_SIZE = 1 << 30;
+
+// amount of bytes the verifier reads and checks at once
+const size_t VERIFY_BATCH_SIZE = 16 << 20;
+
+const char* READ_ERROR = "Error! Reading the framed text failed.";
+const char* NOT_FRAMED_ERROR = "Error! The text is not framed.";
+const char* TRUNCATED_ERROR = "Error! The framed text is truncated.";
+const char* TRAILING_ERROR = "Error! There is text after the end of the framed text.";
+
+// reflected Castagnoli polynomial
+const uint32_t POLYNOMIAL = 0x82f63b78u;
+
+struct Crc_table {
+    uint32_t entries[256];
+};
+
+Crc_table make_crc_table() {
+    Crc_table table;
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        uint32_t crc = byte;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ (POLYNOMIAL & -(crc & 1));
+        table.entries[byte] = crc;
+    }
+    return table;
+}
+
+const Crc_table CRC_TABLE = make_crc_table();
+
+uint32_t crc32c_software(uint32_t crc, const char* data, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        crc = (crc >> 8) ^ CRC_TABLE.entries[(crc ^ static_cast<unsigned char>(data[i])) & 0xff];
+    return crc;
+}
+
+#ifdef FRAMING_X86
+
+// The CRC32 instruction has a latency of three cycles but can start every
+// cycle, so the hardware checksum runs over three parts of the data at
+// once. The checksums of the parts are combined by shifting the first ones
+// over the length of the parts that follow them, which is a multiplication
+// by a constant for a given length, done with tables.
+const size_t LONG_PART = 8192;
+const size_t SHORT_PART = 256;
+
+// shift of a CRC over a given amount of zero bytes, byte by byte
+struct Shift_table {
+    uint32_t entries[4][256];
+};
+
+// product of a 32x32 bit matrix over GF(2) and a vector
+uint32_t gf2_times(const uint32_t* matrix, uint32_t vector) {
+    uint32_t product = 0;
+    for (int bit = 0; vector != 0; ++bit, vector >>= 1) {
+        if (vector & 1)
+            product ^= matrix[bit];
+    }
+    return product;
+}
+
+void gf2_square(uint32_t* square, const uint32_t* matrix) {
+    for (int bit = 0; bit < 32; ++bit)
+        square[bit] = gf2_times(matrix, matrix[bit]);
+}
+
+Shift_table make_shift_table(size_t length) {
+    // operator for one zero bit, squared up to one zero byte and then by
+    // the bits of the length
+    uint32_t odd[32];
+    uint32_t even[32];
+    odd[0] = POLYNOMIAL;
+    for (int bit = 1; bit < 32; ++bit)
+        odd[bit] = 1u << (bit - 1);
+    gf2_square(even, odd);
+    gf2_square(odd, even);
+    gf2_square(even, odd);
+
+    uint32_t shift[32];
+    bool first = true;
+    for (; length != 0; length >>= 1) {
+        if (length & 1) {
+            if (first) {
+                memcpy(shift, even, sizeof(shift));
+                first = false;
+            } else {
+                uint32_t product[32];
+                for (int bit = 0; bit < 32; ++bit)
+                    product[bit] = gf2_times(even, shift[bit]);
+                memcpy(shift, product, sizeof(shift));
+            }
+        }
+        gf2_square(odd, even);
+        memcpy(even, odd, sizeof(even));
+    }
+
+    Shift_table table;
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        for (int i = 0; i < 4; ++i)
+            table.entries[i][byte] = gf2_times(shift, byte << (8 * i));
+    }
+    return table;
+}
+
+const Shift_table LONG_SHIFT = make_shift_table(LONG_PART);
+const Shift_table SHORT_SHIFT = make_shift_table(SHORT_PART);
+
+uint32_t shift_crc(const Shift_table& table, uint32_t crc) {
+    return table.entries[0][crc & 0xff] ^ table.entries[1][(crc >> 8) & 0xff]
+           ^ table.entries[2][(crc >> 16) & 0xff] ^ table.entries[3][crc >> 24];
+}
+
+#ifdef __x86_64__
+
+__attribute__((target("sse4.2")))
+inline uint64_t crc32c_word(uint64_t crc, const char* data) {
+    uint64_t word;
+    memcpy(&word, data, 8);
+    return _mm_crc32_u64(crc, word);
+}
+
+// Checksums three parts of part_size bytes at once while at least that much
+// is left, and combines them into crc.
+__attribute__((target("sse4.2")))
+uint32_t crc32c_parts(uint32_t crc, const char*& data, size_t& n, size_t part_size,
+                      const Shift_table& shift) {
+    while (n >= 3 * part_size) {
+        uint64_t first = crc;
+        uint64_t second = 0;
+        uint64_t third = 0;
+        for (size_t i = 0; i < part_size; i += 8) {
+            first = crc32c_word(first, data + i);
+            second = crc32c_word(second, data + part_size + i);
+            third = crc32c_word(third, data + 2 * part_size + i);
+        }
+        crc = shift_crc(shift, static_cast<uint32_t>(first)) ^ static_cast<uint32_t>(second);
+        crc = shift_crc(shift, crc) ^ static_cast<uint32_t>(third);
+        data += 3 * part_size;
+        n -= 3 * part_size;
+    }
+    return crc;
+}
+
+#endif
+
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const char* data, size_t n) {
+    size_t i = 0;
+#ifdef __x86_64__
+    crc = crc32c_parts(crc, data, n, LONG_PART, LONG_SHIFT);
+    crc = crc32c_parts(crc, data, n, SHORT_PART, SHORT_SHIFT);
+    uint64_t wide = crc;
+    for (; i + 8 <= n; i += 8)
+        wide = crc32c_word(wide, data + i);
+    crc = static_cast<uint32_t>(wide);
+#endif
+    for (; i + 4 <= n; i += 4) {
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; i < n; ++i)
+        crc = _mm_crc32_u8(crc, static_cast<unsigned char>(data[i]));
+    return crc;
+}
+
+bool detect_sse42() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+#endif
+
+void put_u32(char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        out[i] = static_cast<char>(value >> (8 * i));
+}
+
+uint32_t get_u32(const char* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+    return value;
+}
+
+// checksum of a frame with the given header and payload
+uint32_t frame_checksum(const char* header, const char* payload, uint32_t length) {
+    uint32_t crc = crc32c(0, header, 8);
+    return length == END_FRAME ? crc : crc32c(crc, payload, length);
+}
+
+/**
+ * @brief first_bad_frame checks the checksums of frames found in a batch,
+ * split between threads
+ * @param batch the bytes read
+ * @param offsets offsets of the frames in the batch
+ * @param threads amount of threads
+ * @return index of the first frame with a wrong checksum, or the amount of
+ * frames if all are right
+ */
+size_t first_bad_frame(const char* batch, const vector<size_t>& offsets, unsigned int threads) {
+    auto check = [batch, &offsets](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const char* header = batch + offsets[i];
+            uint32_t length = get_u32(header);
+            if (frame_checksum(header, header + FRAME_HEADER_SIZE, length) != get_u32(header + 8))
+                return i;
+        }
+        return offsets.size();
+    };
+
+    threads = static_cast<unsigned int>(min<size_t>(max(1u, threads), offsets.size()));
+    if (threads <= 1)
+        return check(0, offsets.size());
+
+    // Each thread checks a contiguous range and the first bad frame of all
+    // the ranges is the first one of the batch.
+    vector<size_t> bad(threads);
+    vector<thread> checkers;
+    for (unsigned int t = 0; t < threads; ++t) {
+        size_t begin = offsets.size() * t / threads;
+        size_t end = offsets.size() * (t + 1) / threads;
+        checkers.push_back(thread([&check, &bad, t, begin, end]() { bad[t] = check(begin, end); }));
+    }
+    for (thread& checker : checkers)
+        checker.join();
+    return *min_element(bad.begin(), bad.end());
+}
+
+}
+
+
+uint32_t crc32c(uint32_t crc, const char* data, size_t n) {
+#ifdef FRAMING_X86
+    static const bool sse42 = detect_sse42();
+    if (sse42)
+        return ~crc32c_sse42(~crc, data, n);
+#endif
+    return ~crc32c_software(~crc, data, n);
+}
+
+
+void write_stream_header(char* header, size_t frame_size) {
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    put_u32(header + 8, VERSION);
+    put_u32(header + 12, static_cast<uint32_t>(frame_size));
+}
+
+
+void write_frame_header(char* header, const char* payload, uint32_t length, uint32_t sequence) {
+    put_u32(header, length);
+    put_u32(header + 4, sequence);
+    put_u32(header + 8, frame_checksum(header, payload, length));
+}
+
+
+bool verify_frames(FILE* in, unsigned int threads) {
+    char stream_header[STREAM_HEADER_SIZE];
+    size_t frame_size = 0;
+    if (fread(stream_header, 1, STREAM_HEADER_SIZE, in) == STREAM_HEADER_SIZE
+        && memcmp(stream_header, MAGIC, sizeof(MAGIC)) == 0 && get_u32(stream_header + 8) == VERSION)
+        frame_size = get_u32(stream_header + 12);
+    if (frame_size == 0 || frame_size > MAX_FRAME_SIZE) {
+        cerr << (ferror(in) ? READ_ERROR : NOT_FRAMED_ERROR) << endl;
+        return false;
+    }
+
+    // The frames are read in batches. The headers of a batch are walked
+    // through in order, after which the checksums of its whole frames are
+    // checked in parallel and a partial frame at its end is carried over.
+    vector<char> batch(max(VERIFY_BATCH_SIZE, FRAME_HEADER_SIZE + frame_size));
+    size_t filled = 0;
+    size_t offset = 0;
+    uint32_t sequence = 0;
+    bool ended = false;
+    while (!ended) {
+        memmove(batch.data(), batch.data() + offset, filled - offset);
+        filled -= offset;
+        size_t read = fread(batch.data() + filled, 1, batch.size() - filled, in);
+        filled += read;
+
+        uint32_t first_sequence = sequence;
+        vector<size_t> offsets;
+        const char* header_error = nullptr;
+        for (offset = 0; offset + FRAME_HEADER_SIZE <= filled; ++sequence) {
+            const char* header = batch.data() + offset;
+            uint32_t length = get_u32(header);
+            if (length != END_FRAME && length > frame_size) {
+                header_error = "is corrupted";
+                break;
+            }
+            if (get_u32(header + 4) != sequence) {
+                header_error = length == END_FRAME ? "is missing" : "is out of order";
+                break;
+            }
+            size_t frame_end = offset + FRAME_HEADER_SIZE + (length == END_FRAME ? 0 : length);
+            if (frame_end > filled)
+                break;
+            offsets.push_back(offset);
+            offset = frame_end;
+            if (length == END_FRAME) {
+                ended = true;
+                break;
+            }
+        }
+
+        size_t bad = first_bad_frame(batch.data(), offsets, threads);
+        if (bad < offsets.size()) {
+            cerr << "Error! Frame " << first_sequence + bad << " is corrupted." << endl;
+            return false;
+        }
+        if (header_error != nullptr) {
+            cerr << "Error! Frame " << sequence << " " << header_error << "." << endl;
+            return false;
+        }
+        if (!ended && read == 0) {
+            cerr << (ferror(in) ? READ_ERROR : TRUNCATED_ERROR) << endl;
+            return false;
+        }
+    }
+
+    if (offset < filled || fgetc(in) != EOF) {
+        cerr << TRAILING_ERROR << endl;
+        return false;
+    }
+    if (ferror(in)) {
+        cerr << READ_ERROR << endl;
+        return false;
+    }
+    return true;
+}
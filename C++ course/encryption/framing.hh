@@ -0,0 +1,75 @@
+/* Framing
+ *
+ * Framed format for encrypted text, which lets truncation, reordering and
+ * corruption be detected without the key. All numbers are 32-bit little
+ * endian. The text starts with a stream header:
+ *     magic "SUBFRAME", version 1, maximum payload of a frame
+ * followed by frames of the encrypted text in order:
+ *     payload length, sequence number, checksum, payload
+ * and ends with an end frame, whose length is END_FRAME and whose sequence
+ * number is the amount of frames before it. Each checksum is the CRC32C of
+ * the length and sequence number followed by the payload. CRC32C uses the
+ * SSE 4.2 instruction where the CPU has it.
+ */
+
+#ifndef FRAMING_HH
+#define FRAMING_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+using namespace std;
+
+
+// default maximum payload of a frame
+const size_t FRAME_SIZE = 1 << 16;
+
+const size_t STREAM_HEADER_SIZE = 16;
+const size_t FRAME_HEADER_SIZE = 12;
+
+// length of the end frame
+const uint32_t END_FRAME = 0xffffffffu;
+
+
+/**
+ * @brief crc32c continues a CRC32C (Castagnoli) checksum over n bytes
+ * @param crc checksum of the bytes before, 0 to start
+ * @param data bytes to be added
+ * @param n amount of bytes
+ * @return checksum of all the bytes
+ */
+uint32_t crc32c(uint32_t crc, const char* data, size_t n);
+
+
+/**
+ * @brief write_stream_header fills the header that starts a framed text
+ * @param header buffer of STREAM_HEADER_SIZE bytes
+ * @param frame_size maximum payload of the frames
+ */
+void write_stream_header(char* header, size_t frame_size);
+
+
+/**
+ * @brief write_frame_header fills the header of a frame, checksumming its payload
+ * @param header buffer of FRAME_HEADER_SIZE bytes
+ * @param payload the payload of the frame
+ * @param length length of the payload, or END_FRAME for the end frame
+ * without a payload
+ * @param sequence number of the frame, or the amount of frames for the end frame
+ */
+void write_frame_header(char* header, const char* payload, uint32_t length, uint32_t sequence);
+
+
+/**
+ * @brief verify_frames checks a framed text to its end: the headers, the
+ * order of the frames and their checksums, and that it ends with the end
+ * frame. The checksums are checked on the given amount of threads. The
+ * first error is printed to cerr.
+ * @param in framed text
+ * @param threads amount of threads checking checksums
+ * @return True if the text is intact, False if it is not or cannot be read
+ */
+bool verify_frames(FILE* in, unsigned int threads = 1);
+
+#endif // FRAMING_HH
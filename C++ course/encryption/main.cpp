@@ -5,87 +5,206 @@
 * that will be used as an encryption key similar to Caesar cipher.
 * After key creation, the user can input a string and the program will print the same 
 * line using the encryption key.
+*
+* Given command line arguments, the program instead encrypts a file or standard input
+* to standard output in streaming mode:
+*     encryption --key KEY [--decrypt] [--passthrough] [--framed] [--threads N] [FILE|-]
+*     encryption --key KEY [--decrypt] [--passthrough] (--in-place | --output OUT) FILE
+*     encryption --verify [--threads N] [FILE|-]
+* --key may be given several times for a polyalphabetic cipher, where character i of
+* the text is encrypted with key i % keys like in a Vigenere cipher.
+* With --decrypt, text encrypted with the same keys is decrypted instead.
+* Characters other than a-z are dropped, or kept unchanged with --passthrough.
+* --threads encrypts with N worker threads, at most 1024, or with one per core for 0.
+* --in-place and --output encrypt FILE through memory mappings instead of streaming,
+* over itself or into the file OUT.
+* --framed writes the output in checksummed frames, and --verify checks such output
+* for truncation and corruption without the key.
 */
 
-#include <iostream>
+#include "cipher.hh"
+#include "encryption.hh"
+#include "file_encryption.hh"
+#include "framing.hh"
+#include "stream.hh"
+#include <algorithm>
 #include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
 
+// Most worker threads that --threads accepts.
+const unsigned long MAX_THREADS = 1024;
+
+
 /**
- * @brief check_if_lowercase checks if all the letters of a given string are lowercase anglican letters
- * @param str string to be checked
- * @return True if all lowercase, False if non-lowercase found
+ * @brief print_usage prints the command line usage of the streaming mode to cerr
+ * @param program name of the program
  */
-bool check_if_lowercase(string str) {
-    for (char c : str) {
-        if (!islower(c)) {
-            return false;
-        }
-    }
-    return true;
+void print_usage(const char* program)
+{
+    cerr << "Usage: " << program
+         << " --key KEY [--key KEY ...] [--decrypt] [--passthrough] [--framed] [--threads N] [FILE|-]"
+         << endl
+         << "       " << program
+         << " --key KEY [--key KEY ...] [--decrypt] [--passthrough] (--in-place | --output OUT) FILE"
+         << endl
+         << "       " << program << " --verify [--threads N] [FILE|-]" << endl;
 }
 
 
 /**
- * @brief check_key_validity checks if an encryption key is valid (all anglican lowercase, 
- * with 26 non-duplicate letters only)
- * @param key key to be checked
- * @return True if valid, False if invalid
+ * @brief parse_threads parses the value of --threads
+ * @param str value given on the command line
+ * @param threads set to the amount of worker threads, one per core for 0
+ * @return True if str is a whole number from 0 to MAX_THREADS
  */
-bool check_key_validity(string key) {
-    // key length
-    if (key.length() != 26) {
-        cout << "Error! The encryption key must contain 26 characters." << endl;
-        return false;
-    }
-
-    // lowercase anglican alphabet
-    if (!check_if_lowercase(key)) {
-        cout << "Error! The encryption key must contain lower case characters only." << endl;
+bool parse_threads(const char* str, unsigned int& threads)
+{
+    char* end = nullptr;
+    unsigned long number = strtoul(str, &end, 10);
+    if (!isdigit(static_cast<unsigned char>(str[0])) || *end != '\0' || number > MAX_THREADS)
         return false;
-    }
+    threads = number == 0 ? min(max(1u, thread::hardware_concurrency()),
+                                static_cast<unsigned int>(MAX_THREADS))
+                          : static_cast<unsigned int>(number);
+    return true;
+}
 
 
-    // contains all anglican letters = has no duplicate letters
-    for (string::size_type i = 0; i < key.length()-1; ++i)
-        for (string::size_type j = i+1; j < key.length(); ++j)
-            if (key[i] == key[j]) {
-                cout << "Error! The encryption key must contain all alphabets a-z." << endl;
-                return false;
-            }
-    return true;
+/**
+ * @brief open_input opens a file for reading, or gives standard input for "-"
+ * @param path path of the file, or "-"
+ * @return the stream, or nullptr after printing an error
+ */
+FILE* open_input(const string& path)
+{
+    if (path == "-")
+        return stdin;
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr)
+        cerr << "Error! Cannot open " << path << "." << endl;
+    return in;
 }
 
 
 /**
- * @brief encrypt encrypts a string
- * @param str string to be encrypted
- * @param key encryption key to be used
- * @return encrypted string
+ * @brief command_line_main encrypts or decrypts a file or standard input to standard
+ * output, or a file over itself or into another file, or verifies framed output.
+ * Standard output may carry the encrypted text, so messages go to cerr.
+ * @param argc amount of command line arguments
+ * @param argv command line arguments
+ * @return EXIT_SUCCESS, or EXIT_FAILURE on a usage, key or I/O error
  */
-string encrypt(string str, string key) {
-    string encrypted_string = "";
-    string alphabets = "abcdefghijklmnopqrstuvwxyz";
-    for (char c : str) {
-        for (string::size_type i = 0; i < alphabets.length(); ++i) {
-            if (c == alphabets[i]) {
-                encrypted_string += key[i];
+int command_line_main(int argc, char* argv[])
+{
+    vector<string> keys;
+    bool decrypt = false;
+    bool passthrough = false;
+    bool framed = false;
+    bool verify = false;
+    unsigned int threads = 1;
+    bool in_place = false;
+    string output;
+    string path = "-";
+    bool has_path = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        if (argument == "--key" && i + 1 < argc) {
+            keys.push_back(argv[++i]);
+        } else if (argument == "--decrypt") {
+            decrypt = true;
+        } else if (argument == "--passthrough") {
+            passthrough = true;
+        } else if (argument == "--framed") {
+            framed = true;
+        } else if (argument == "--verify") {
+            verify = true;
+        } else if (argument == "--threads" && i + 1 < argc) {
+            if (!parse_threads(argv[++i], threads)) {
+                cerr << "Error! --threads takes a number from 0 to " << MAX_THREADS << "." << endl;
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
             }
+        } else if (argument == "--in-place") {
+            in_place = true;
+        } else if (argument == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (!has_path && (argument == "-" || argument.compare(0, 1, "-") != 0)) {
+            path = argument;
+            has_path = true;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
         }
     }
-    return encrypted_string;
+    bool mapped = in_place || !output.empty();
+    bool encrypting = !keys.empty() || decrypt || passthrough || framed || mapped;
+    if ((verify && encrypting) || (!verify && keys.empty()) || (in_place && !output.empty())
+        || (mapped && (path == "-" || framed))) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (verify) {
+        FILE* in = open_input(path);
+        if (in == nullptr)
+            return EXIT_FAILURE;
+        bool intact = verify_frames(in, threads);
+        if (in != stdin)
+            fclose(in);
+        return intact ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    for (string& key : keys) {
+        const char* error = key_error(key);
+        if (error != nullptr) {
+            cerr << error << endl;
+            return EXIT_FAILURE;
+        }
+        // Decrypting is encrypting with the inverse keys.
+        if (decrypt)
+            key = invert_key(key);
+    }
+    Cipher cipher;
+    cipher.set_keys(keys);
+    cipher.set_passthrough(passthrough);
+
+    if (in_place)
+        return encrypt_file_in_place(cipher, path) ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (!output.empty())
+        return encrypt_file_to(cipher, path, output) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    FILE* in = open_input(path);
+    if (in == nullptr)
+        return EXIT_FAILURE;
+
+    bool ok = framed ? encrypt_framed_stream(cipher, in, stdout, FRAME_SIZE, threads)
+                     : encrypt_stream(cipher, in, stdout, STREAM_CHUNK_SIZE, threads);
+    if (in != stdin)
+        fclose(in);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 
-int main()
+int main(int argc, char* argv[])
 {
+    if (argc > 1)
+        return command_line_main(argc, argv);
+
     string key;
     cout << "Enter the encryption key: (26 unique lowercase characters a-z, no spaces) ";
     cin >> key;
 
-    if (!check_key_validity(key))
+    Cipher cipher;
+    if (!cipher.set_key(key))
         return EXIT_FAILURE;
 
     string text_to_be_encrypted;
@@ -97,7 +216,7 @@ int main()
         return EXIT_FAILURE;
     }
 
-    string encrypted_text = encrypt(text_to_be_encrypted, key);
+    string encrypted_text = cipher.encrypt(text_to_be_encrypted);
     cout << "Encrypted text: " << encrypted_text << endl;
 
     return 0;
@@ -0,0 +1,285 @@
+/* Stream
+ *
+ * Encryption of files and pipes chunk by chunk, on one thread or in a
+ * pipeline of a reader, workers and a writer, plainly or in frames.
+ */
+
+#include "stream.hh"
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const char* READ_ERROR = "Error! Reading the text to be encrypted failed.";
+const char* WRITE_ERROR = "Error! Writing the encrypted text failed.";
+
+// A chunk of the text. In the pipeline it is owned in turn by the reader
+// while FREE, by a worker while READ and by the writer while ENCRYPTED.
+struct Chunk {
+    enum State {FREE, READ, ENCRYPTED};
+
+    vector<char> data;
+    size_t size = 0;
+    // amount of letters before the chunk, for sequences of keys
+    size_t position = 0;
+    State state = FREE;
+
+    // When framing, the chunk is split into frames of frame_size
+    // characters, whose payloads stay at the start of their own part of
+    // data. first_frame is the sequence number of the first one.
+    uint32_t first_frame = 0;
+    vector<char> frame_headers;
+    vector<size_t> frame_lengths;
+};
+
+
+/**
+ * @brief read_chunk reads the next chunk of the text
+ * @param position amount of letters before the chunk, moved past it
+ * @param frames amount of frames before the chunk, moved past it
+ * @return amount of characters read, 0 at the end of the input or on an error
+ */
+size_t read_chunk(const Cipher& cipher, FILE* in, Chunk& chunk, size_t chunk_size, size_t frame_size,
+                  size_t& position, uint32_t& frames) {
+    // Chunks are allocated on first use, so short inputs stay small.
+    chunk.data.resize(chunk_size);
+    size_t read = fread(chunk.data.data(), 1, chunk_size, in);
+    chunk.size = read;
+    // Only the letters move a sequence of keys on, so they are counted
+    // before the chunk is encrypted.
+    chunk.position = position;
+    if (cipher.key_count() > 1)
+        position += count_letters(chunk.data.data(), read);
+    chunk.first_frame = frames;
+    if (frame_size != 0)
+        frames += static_cast<uint32_t>((read + frame_size - 1) / frame_size);
+    return read;
+}
+
+
+/**
+ * @brief encrypt_chunk encrypts a chunk in place. When framing, each frame
+ * is checksummed right after it is encrypted, while it is still in cache.
+ * @param frame_size size of the frames, 0 for no frames
+ */
+void encrypt_chunk(const Cipher& cipher, Chunk& chunk, size_t frame_size) {
+    if (frame_size == 0) {
+        chunk.size = cipher.encrypt(chunk.data.data(), chunk.size, chunk.data.data(), chunk.position);
+        return;
+    }
+
+    size_t frames = (chunk.size + frame_size - 1) / frame_size;
+    chunk.frame_headers.resize(frames * FRAME_HEADER_SIZE);
+    chunk.frame_lengths.resize(frames);
+    size_t position = chunk.position;
+    for (size_t f = 0; f < frames; ++f) {
+        char* frame = chunk.data.data() + f * frame_size;
+        size_t size = min(frame_size, chunk.size - f * frame_size);
+        size_t letters = cipher.key_count() > 1 ? count_letters(frame, size) : 0;
+        size_t length = cipher.encrypt(frame, size, frame, position);
+        position += letters;
+        chunk.frame_lengths[f] = length;
+        write_frame_header(&chunk.frame_headers[f * FRAME_HEADER_SIZE], frame,
+                           static_cast<uint32_t>(length), chunk.first_frame + static_cast<uint32_t>(f));
+    }
+}
+
+
+/**
+ * @brief write_chunk writes an encrypted chunk, with the headers of its frames
+ * @return False on a write error
+ */
+bool write_chunk(const Chunk& chunk, FILE* out, size_t frame_size) {
+    if (frame_size == 0)
+        return fwrite(chunk.data.data(), 1, chunk.size, out) == chunk.size;
+
+    for (size_t f = 0; f < chunk.frame_lengths.size(); ++f) {
+        size_t length = chunk.frame_lengths[f];
+        if (fwrite(&chunk.frame_headers[f * FRAME_HEADER_SIZE], 1, FRAME_HEADER_SIZE, out)
+                != FRAME_HEADER_SIZE
+            || fwrite(chunk.data.data() + f * frame_size, 1, length, out) != length)
+            return false;
+    }
+    return true;
+}
+
+
+bool encrypt_on_one_thread(const Cipher& cipher, FILE* in, FILE* out, size_t chunk_size,
+                           size_t frame_size, uint32_t& frames) {
+    Chunk chunk;
+    size_t position = 0;
+    while (read_chunk(cipher, in, chunk, chunk_size, frame_size, position, frames) != 0) {
+        encrypt_chunk(cipher, chunk, frame_size);
+        if (!write_chunk(chunk, out, frame_size)) {
+            cerr << WRITE_ERROR << endl;
+            return false;
+        }
+    }
+
+    if (ferror(in)) {
+        cerr << READ_ERROR << endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool encrypt_in_pipeline(const Cipher& cipher, FILE* in, FILE* out, size_t chunk_size,
+                         size_t frame_size, unsigned int threads, uint32_t& frames) {
+    // Chunk number n always goes through chunks[n % chunks.size()]. Two
+    // chunks per worker keep the workers busy while the reader and the
+    // writer wait for I/O, and bound the memory used.
+    vector<Chunk> chunks(2 * threads + 2);
+    mutex chunks_mutex;
+    condition_variable changed;
+    size_t read_chunks = 0;
+    size_t taken_chunks = 0;
+    bool end_of_input = false;
+    bool read_failed = false;
+    bool stopped = false;
+
+    thread reader([&]() {
+        size_t position = 0;
+        for (size_t n = 0; ; ++n) {
+            Chunk& chunk = chunks.at(n % chunks.size());
+            {
+                unique_lock<mutex> lock(chunks_mutex);
+                changed.wait(lock, [&]() { return chunk.state == Chunk::FREE || stopped; });
+                if (stopped)
+                    break;
+            }
+
+            size_t read = read_chunk(cipher, in, chunk, chunk_size, frame_size, position, frames);
+
+            lock_guard<mutex> lock(chunks_mutex);
+            if (read == 0) {
+                read_failed = ferror(in) != 0;
+                end_of_input = true;
+                changed.notify_all();
+                break;
+            }
+            chunk.state = Chunk::READ;
+            ++read_chunks;
+            changed.notify_all();
+        }
+    });
+
+    vector<thread> workers;
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.push_back(thread([&]() {
+            while (true) {
+                size_t n;
+                {
+                    unique_lock<mutex> lock(chunks_mutex);
+                    changed.wait(lock, [&]() {
+                        return taken_chunks < read_chunks || end_of_input || stopped;
+                    });
+                    if (taken_chunks == read_chunks || stopped)
+                        break;
+                    n = taken_chunks++;
+                }
+
+                Chunk& chunk = chunks.at(n % chunks.size());
+                encrypt_chunk(cipher, chunk, frame_size);
+
+                lock_guard<mutex> lock(chunks_mutex);
+                chunk.state = Chunk::ENCRYPTED;
+                changed.notify_all();
+            }
+        }));
+    }
+
+    // The calling thread writes the chunks in the order they were read.
+    bool written = true;
+    for (size_t n = 0; ; ++n) {
+        Chunk& chunk = chunks.at(n % chunks.size());
+        {
+            unique_lock<mutex> lock(chunks_mutex);
+            changed.wait(lock, [&]() {
+                return chunk.state == Chunk::ENCRYPTED || (end_of_input && n == read_chunks);
+            });
+            if (chunk.state != Chunk::ENCRYPTED)
+                break;
+        }
+
+        written = write_chunk(chunk, out, frame_size);
+
+        lock_guard<mutex> lock(chunks_mutex);
+        if (!written) {
+            stopped = true;
+            changed.notify_all();
+            break;
+        }
+        chunk.state = Chunk::FREE;
+        changed.notify_all();
+    }
+
+    reader.join();
+    for (thread& worker : workers)
+        worker.join();
+
+    if (!written) {
+        cerr << WRITE_ERROR << endl;
+        return false;
+    }
+    if (read_failed) {
+        cerr << READ_ERROR << endl;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief encrypt encrypts in to out, in frames of frame_size characters
+ * between a stream header and an end frame unless frame_size is 0
+ */
+bool encrypt(const Cipher& cipher, FILE* in, FILE* out, size_t chunk_size, size_t frame_size,
+             unsigned int threads) {
+    if (frame_size != 0) {
+        char header[STREAM_HEADER_SIZE];
+        write_stream_header(header, frame_size);
+        if (fwrite(header, 1, STREAM_HEADER_SIZE, out) != STREAM_HEADER_SIZE) {
+            cerr << WRITE_ERROR << endl;
+            return false;
+        }
+    }
+
+    uint32_t frames = 0;
+    bool ok = threads <= 1 ? encrypt_on_one_thread(cipher, in, out, chunk_size, frame_size, frames)
+                           : encrypt_in_pipeline(cipher, in, out, chunk_size, frame_size, threads, frames);
+    if (ok && frame_size != 0) {
+        char end_frame[FRAME_HEADER_SIZE];
+        write_frame_header(end_frame, nullptr, END_FRAME, frames);
+        ok = fwrite(end_frame, 1, FRAME_HEADER_SIZE, out) == FRAME_HEADER_SIZE;
+        if (!ok)
+            cerr << WRITE_ERROR << endl;
+    }
+    if (ok && fflush(out) != 0) {
+        cerr << WRITE_ERROR << endl;
+        return false;
+    }
+    return ok;
+}
+
+}
+
+
+bool encrypt_stream(const Cipher& cipher, FILE* in, FILE* out, size_t chunk_size,
+                    unsigned int threads) {
+    return encrypt(cipher, in, out, chunk_size, 0, threads);
+}
+
+
+bool encrypt_framed_stream(const Cipher& cipher, FILE* in, FILE* out, size_t frame_size,
+                           unsigned int threads) {
+    // Chunks hold whole frames, so that only the last frame is shorter.
+    size_t chunk_size = max<size_t>(1, STREAM_CHUNK_SIZE / frame_size) * frame_size;
+    return encrypt(cipher, in, out, chunk_size, frame_size, threads);
+}
@@ -0,0 +1,54 @@
+/* Stream
+ *
+ * Encryption of files and pipes chunk by chunk, so that inputs of any size
+ * are encrypted in constant memory. With more than one thread the chunks
+ * go through a pipeline: a reader thread reads them, worker threads encrypt
+ * them in place and the calling thread writes them out in order. The
+ * output can also be framed, so that its integrity can be verified.
+ */
+
+#ifndef STREAM_HH
+#define STREAM_HH
+
+#include "cipher.hh"
+#include "framing.hh"
+#include <cstddef>
+#include <cstdio>
+
+using namespace std;
+
+
+// size of the chunks read and encrypted at once
+const size_t STREAM_CHUNK_SIZE = 1 << 20;
+
+
+/**
+ * @brief encrypt_stream reads in to its end, encrypts it chunk by chunk in
+ * place and writes the encrypted chunks to out. Errors are printed to cerr.
+ * @param cipher cipher with a key
+ * @param in stream to be encrypted
+ * @param out stream for the encrypted characters
+ * @param chunk_size amount of characters read at once
+ * @param threads amount of worker threads; with more than one, at most
+ * 2 * threads + 2 chunks are in memory at once
+ * @return True if everything was read and written, False on an I/O error
+ */
+bool encrypt_stream(const Cipher& cipher, FILE* in, FILE* out,
+                    size_t chunk_size = STREAM_CHUNK_SIZE, unsigned int threads = 1);
+
+
+
+/**
+ * @brief encrypt_framed_stream encrypts in to out like encrypt_stream, but in
+ * the framed format of framing.hh, so that the output can be verified
+ * @param cipher cipher with a key
+ * @param in stream to be encrypted
+ * @param out stream for the framed text
+ * @param frame_size amount of characters encrypted into each frame
+ * @param threads amount of worker threads, like for encrypt_stream
+ * @return True if everything was read and written, False on an I/O error
+ */
+bool encrypt_framed_stream(const Cipher& cipher, FILE* in, FILE* out,
+                           size_t frame_size = FRAME_SIZE, unsigned int threads = 1);
+
+#endif // STREAM_HH
@@ -0,0 +1,640 @@
+/* Substitution
+ *
+ * Scalar and vector substitution kernels and the run time dispatch.
+ */
+
+#include "substitution.hh"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUBSTITUTION_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+size_t substitute_scalar(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    // Every character is written, but the output position only moves on
+    // past the ones that are kept, so there is no branch per character.
+    size_t written = 0;
+    for (size_t i = 0; i < n; ++i) {
+        char c = tables.table[static_cast<unsigned char>(in[i])];
+        out[written] = c;
+        written += c != 0;
+    }
+    return written;
+}
+
+size_t pass_through_scalar(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    for (size_t i = 0; i < n; ++i)
+        out[i] = tables.table[static_cast<unsigned char>(in[i])];
+    return n;
+}
+
+size_t substitute_sequence_scalar(const Key_sequence_tables& tables, size_t key,
+                                  const char* in, size_t n, char* out) {
+    const size_t keys = tables.keys.size();
+    const bool passthrough = tables.passthrough;
+    size_t written = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char c = static_cast<unsigned char>(in[i]);
+        char substitute = tables.table[key * 256 + c];
+        out[written] = substitute;
+        written += substitute != 0 || passthrough;
+        key += static_cast<unsigned char>(c - 'a') < 26;
+        key = key == keys ? 0 : key;
+    }
+    return written;
+}
+
+#ifdef SUBSTITUTION_X86
+
+// The vector kernels substitute whole blocks of letters a-z at once. When
+// dropping, the substitutes of the letters in a block are packed to the
+// front before storing; when passing through, the other characters are
+// blended back over their substitutes. Writing a block never reaches past
+// the input already read, so in and out may be the same buffer.
+
+// Shuffle indices that pack the bytes selected by an 8-bit mask to the front.
+struct Pack_table {
+    unsigned char indices[256][8];
+    unsigned char counts[256];
+};
+
+Pack_table make_pack_table() {
+    Pack_table table;
+    for (int mask = 0; mask < 256; ++mask) {
+        int count = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            if (mask & (1 << bit))
+                table.indices[mask][count++] = static_cast<unsigned char>(bit);
+        }
+        for (int unused = count; unused < 8; ++unused)
+            table.indices[mask][unused] = 0x80;
+        table.counts[mask] = static_cast<unsigned char>(count);
+    }
+    return table;
+}
+
+const Pack_table PACK_TABLE = make_pack_table();
+
+// Stores the bytes of a block selected by keep, packed, to out.
+__attribute__((target("ssse3")))
+inline size_t pack_16(__m128i block, int keep, char* out) {
+    int low = keep & 0xff;
+    int high = keep >> 8;
+    __m128i low_indices = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(PACK_TABLE.indices[low]));
+    __m128i high_indices = _mm_add_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(PACK_TABLE.indices[high])), _mm_set1_epi8(8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(block, low_indices));
+    size_t written = PACK_TABLE.counts[low];
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + written), _mm_shuffle_epi8(block, high_indices));
+    return written + PACK_TABLE.counts[high];
+}
+
+// Offsets of the characters from 'a', which are below 26 for a-z only.
+__attribute__((target("ssse3")))
+inline __m128i letters_16(__m128i c) {
+    return _mm_sub_epi8(c, _mm_set1_epi8('a'));
+}
+
+__attribute__((target("ssse3")))
+inline __m128i lowercase_16(__m128i letter) {
+    return _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8('z' - 'a')), letter);
+}
+
+// Shuffle indices of the letters into the first and the second half of a
+// key. A shuffle gives 0 for indices with the high bit set: q-z are turned
+// into such indices for the first half, and a-p wrap around into them when
+// q is subtracted for the second half.
+struct Half_indices_16 {
+    __m128i first;
+    __m128i second;
+};
+
+__attribute__((target("ssse3")))
+inline Half_indices_16 half_indices_16(__m128i letter) {
+    __m128i in_second = _mm_cmpgt_epi8(letter, _mm_set1_epi8('p' - 'a'));
+    return {_mm_or_si128(letter, in_second), _mm_sub_epi8(letter, _mm_set1_epi8('q' - 'a'))};
+}
+
+__attribute__((target("ssse3")))
+inline __m128i lookup_16(__m128i first_half, __m128i second_half, Half_indices_16 indices) {
+    return _mm_or_si128(_mm_shuffle_epi8(first_half, indices.first),
+                        _mm_shuffle_epi8(second_half, indices.second));
+}
+
+// Stores the substitutes of the letters of a block packed, or the whole
+// block when it has letters only.
+__attribute__((target("ssse3")))
+inline size_t store_letters_16(__m128i substitute, __m128i lowercase, char* out) {
+    int keep = _mm_movemask_epi8(lowercase);
+    if (keep == 0xffff) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), substitute);
+        return 16;
+    }
+    return pack_16(substitute, keep, out);
+}
+
+// Stores the substitutes of the letters of a block and the other characters
+// unchanged.
+__attribute__((target("ssse3")))
+inline void store_blended_16(__m128i c, __m128i substitute, __m128i lowercase, char* out) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm_or_si128(_mm_and_si128(lowercase, substitute), _mm_andnot_si128(lowercase, c)));
+}
+
+// The same for 32-byte blocks, where shuffles work within 128-bit lanes, so
+// both lanes get the same halves of a key.
+
+__attribute__((target("avx2")))
+inline __m256i letters_32(__m256i c) {
+    return _mm256_sub_epi8(c, _mm256_set1_epi8('a'));
+}
+
+__attribute__((target("avx2")))
+inline __m256i lowercase_32(__m256i letter) {
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8('z' - 'a')), letter);
+}
+
+struct Half_indices_32 {
+    __m256i first;
+    __m256i second;
+};
+
+__attribute__((target("avx2")))
+inline Half_indices_32 half_indices_32(__m256i letter) {
+    __m256i in_second = _mm256_cmpgt_epi8(letter, _mm256_set1_epi8('p' - 'a'));
+    return {_mm256_or_si256(letter, in_second), _mm256_sub_epi8(letter, _mm256_set1_epi8('q' - 'a'))};
+}
+
+__attribute__((target("avx2")))
+inline __m256i broadcast_half(const char* half) {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(half)));
+}
+
+__attribute__((target("avx2")))
+inline __m256i lookup_32(__m256i first_half, __m256i second_half, Half_indices_32 indices) {
+    return _mm256_or_si256(_mm256_shuffle_epi8(first_half, indices.first),
+                           _mm256_shuffle_epi8(second_half, indices.second));
+}
+
+__attribute__((target("avx2")))
+inline size_t store_letters_32(__m256i substitute, __m256i lowercase, char* out) {
+    unsigned int keep = static_cast<unsigned int>(_mm256_movemask_epi8(lowercase));
+    if (keep == 0xffffffffu) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), substitute);
+        return 32;
+    }
+    size_t written = pack_16(_mm256_castsi256_si128(substitute), keep & 0xffff, out);
+    return written + pack_16(_mm256_extracti128_si256(substitute, 1), keep >> 16, out + written);
+}
+
+__attribute__((target("avx2")))
+inline void store_blended_32(__m256i c, __m256i substitute, __m256i lowercase, char* out) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_blendv_epi8(c, substitute, lowercase));
+}
+
+__attribute__((target("ssse3")))
+size_t substitute_ssse3(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    const __m128i first_half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.first_half));
+    const __m128i second_half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.second_half));
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i letter = letters_16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        __m128i substitute = lookup_16(first_half, second_half, half_indices_16(letter));
+        written += store_letters_16(substitute, lowercase_16(letter), out + written);
+    }
+    return written + substitute_scalar(tables, in + i, n - i, out + written);
+}
+
+__attribute__((target("avx2")))
+size_t substitute_avx2(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    const __m256i first_half = broadcast_half(tables.first_half);
+    const __m256i second_half = broadcast_half(tables.second_half);
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i letter = letters_32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+        __m256i substitute = lookup_32(first_half, second_half, half_indices_32(letter));
+        written += store_letters_32(substitute, lowercase_32(letter), out + written);
+    }
+    // The SSSE3 code is not VEX encoded, so the upper halves of the
+    // registers are cleared first to avoid a state transition on each call.
+    _mm256_zeroupper();
+    return written + substitute_ssse3(tables, in + i, n - i, out + written);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi,avx512vbmi2,popcnt")))
+size_t substitute_avx512(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    // A byte permute looks up all 64 bytes by their six low bits, which
+    // tell the letters a-z apart, and a compress packs the letters.
+    const __m512i by_low_bits = _mm512_loadu_si512(tables.by_low_bits);
+    const __m512i a = _mm512_set1_epi8('a');
+    const __m512i letters = _mm512_set1_epi8(26);
+    const __mmask64 all = ~__mmask64(0);
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i c = _mm512_loadu_si512(in + i);
+        __mmask64 keep = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(c, a), letters);
+        __m512i substitute = _mm512_maskz_permutexvar_epi8(all, c, by_low_bits);
+        _mm512_storeu_si512(out + written, _mm512_maskz_compress_epi8(keep, substitute));
+        written += __builtin_popcountll(keep);
+    }
+    return written + substitute_avx2(tables, in + i, n - i, out + written);
+}
+
+__attribute__((target("ssse3")))
+size_t pass_through_ssse3(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    const __m128i first_half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.first_half));
+    const __m128i second_half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.second_half));
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i letter = letters_16(c);
+        __m128i substitute = lookup_16(first_half, second_half, half_indices_16(letter));
+        store_blended_16(c, substitute, lowercase_16(letter), out + i);
+    }
+    return i + pass_through_scalar(tables, in + i, n - i, out + i);
+}
+
+__attribute__((target("avx2")))
+size_t pass_through_avx2(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    const __m256i first_half = broadcast_half(tables.first_half);
+    const __m256i second_half = broadcast_half(tables.second_half);
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i letter = letters_32(c);
+        __m256i substitute = lookup_32(first_half, second_half, half_indices_32(letter));
+        store_blended_32(c, substitute, lowercase_32(letter), out + i);
+    }
+    _mm256_zeroupper();
+    return i + pass_through_ssse3(tables, in + i, n - i, out + i);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi,avx512vbmi2,popcnt")))
+size_t pass_through_avx512(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    const __m512i by_low_bits = _mm512_loadu_si512(tables.by_low_bits);
+    const __m512i a = _mm512_set1_epi8('a');
+    const __m512i letters = _mm512_set1_epi8(26);
+
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i c = _mm512_loadu_si512(in + i);
+        __mmask64 lowercase = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(c, a), letters);
+        _mm512_storeu_si512(out + i, _mm512_mask_permutexvar_epi8(c, lowercase, c, by_low_bits));
+    }
+    return i + pass_through_avx2(tables, in + i, n - i, out + i);
+}
+
+// The key sequence kernels find the key of each letter of a block from its
+// rank among the letters of the block, look the block up with every key and
+// pick the substitute of its own key for each letter, so their work per
+// block grows with the amount of keys. Each kernel handles both dropping
+// and passing through, and leaves the tail to the scalar kernel.
+
+// Amount of letters up to and including each byte of a block.
+__attribute__((target("ssse3")))
+inline __m128i letter_counts_16(__m128i lowercase) {
+    __m128i counts = _mm_and_si128(lowercase, _mm_set1_epi8(1));
+    counts = _mm_add_epi8(counts, _mm_slli_si128(counts, 1));
+    counts = _mm_add_epi8(counts, _mm_slli_si128(counts, 2));
+    counts = _mm_add_epi8(counts, _mm_slli_si128(counts, 4));
+    return _mm_add_epi8(counts, _mm_slli_si128(counts, 8));
+}
+
+__attribute__((target("avx2")))
+inline __m256i letter_counts_32(__m256i lowercase) {
+    __m256i counts = _mm256_and_si256(lowercase, _mm256_set1_epi8(1));
+    counts = _mm256_add_epi8(counts, _mm256_slli_si256(counts, 1));
+    counts = _mm256_add_epi8(counts, _mm256_slli_si256(counts, 2));
+    counts = _mm256_add_epi8(counts, _mm256_slli_si256(counts, 4));
+    counts = _mm256_add_epi8(counts, _mm256_slli_si256(counts, 8));
+    // The shifts stay within 128-bit lanes, so the letters of the low lane
+    // are added to the high lane.
+    __m256i low_total = _mm256_shuffle_epi8(counts, _mm256_set1_epi8(15));
+    return _mm256_add_epi8(counts, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+}
+
+__attribute__((target("ssse3")))
+size_t substitute_sequence_ssse3(const Key_sequence_tables& tables, size_t key,
+                                 const char* in, size_t n, char* out) {
+    const size_t keys = tables.keys.size();
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i letter = letters_16(c);
+        __m128i lowercase = lowercase_16(letter);
+        __m128i counts = letter_counts_16(lowercase);
+        const unsigned char* rotation = tables.rotation.data() + key * 128;
+        __m128i lane_keys = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(rotation)), _mm_slli_si128(counts, 1));
+
+        Half_indices_16 indices = half_indices_16(letter);
+        __m128i substitute = _mm_setzero_si128();
+        for (size_t k = 0; k < keys; ++k) {
+            const Substitution_tables& key_tables = tables.keys[k];
+            __m128i own = _mm_cmpeq_epi8(lane_keys, _mm_set1_epi8(static_cast<char>(k)));
+            __m128i key_substitute = lookup_16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(key_tables.first_half)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(key_tables.second_half)), indices);
+            substitute = _mm_or_si128(substitute, _mm_and_si128(own, key_substitute));
+        }
+        key = rotation[_mm_extract_epi16(counts, 7) >> 8];
+
+        if (tables.passthrough) {
+            store_blended_16(c, substitute, lowercase, out + written);
+            written += 16;
+        } else {
+            written += store_letters_16(substitute, lowercase, out + written);
+        }
+    }
+    return written + substitute_sequence_scalar(tables, key, in + i, n - i, out + written);
+}
+
+__attribute__((target("avx2")))
+size_t substitute_sequence_avx2(const Key_sequence_tables& tables, size_t key,
+                                const char* in, size_t n, char* out) {
+    const size_t keys = tables.keys.size();
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i letter = letters_32(c);
+        __m256i lowercase = lowercase_32(letter);
+        __m256i counts = letter_counts_32(lowercase);
+        // The ranks of the letters index the next 32 keys like letters
+        // index a key.
+        const unsigned char* rotation = tables.rotation.data() + key * 128;
+        __m256i ranks = _mm256_sub_epi8(counts, _mm256_and_si256(lowercase, _mm256_set1_epi8(1)));
+        __m256i lane_keys = lookup_32(broadcast_half(reinterpret_cast<const char*>(rotation)),
+                                      broadcast_half(reinterpret_cast<const char*>(rotation + 16)),
+                                      half_indices_32(ranks));
+
+        Half_indices_32 indices = half_indices_32(letter);
+        __m256i substitute = _mm256_setzero_si256();
+        for (size_t k = 0; k < keys; ++k) {
+            const Substitution_tables& key_tables = tables.keys[k];
+            __m256i own = _mm256_cmpeq_epi8(lane_keys, _mm256_set1_epi8(static_cast<char>(k)));
+            __m256i key_substitute = lookup_32(broadcast_half(key_tables.first_half),
+                                               broadcast_half(key_tables.second_half), indices);
+            substitute = _mm256_or_si256(substitute, _mm256_and_si256(own, key_substitute));
+        }
+        key = rotation[static_cast<unsigned char>(_mm256_extract_epi8(counts, 31))];
+
+        if (tables.passthrough) {
+            store_blended_32(c, substitute, lowercase, out + written);
+            written += 32;
+        } else {
+            written += store_letters_32(substitute, lowercase, out + written);
+        }
+    }
+    _mm256_zeroupper();
+    return written + substitute_sequence_scalar(tables, key, in + i, n - i, out + written);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi,avx512vbmi2,popcnt")))
+size_t substitute_sequence_avx512(const Key_sequence_tables& tables, size_t key,
+                                  const char* in, size_t n, char* out) {
+    // An expand gives each letter its rank among the letters of the block.
+    // A two-table byte permute looks up 128 bytes, which hold a group of
+    // four keys indexed by the five low bits of the letters, so each group
+    // of keys costs one permute per block.
+    const size_t keys = tables.keys.size();
+    const size_t groups = (keys + 3) / 4;
+    unsigned char lanes[64];
+    for (int lane = 0; lane < 64; ++lane)
+        lanes[lane] = static_cast<unsigned char>(lane);
+    const __m512i ranks = _mm512_loadu_si512(lanes);
+    const __m512i a = _mm512_set1_epi8('a');
+    const __m512i letters = _mm512_set1_epi8(26);
+    const __mmask64 all = ~__mmask64(0);
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i c = _mm512_loadu_si512(in + i);
+        __mmask64 lowercase = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(c, a), letters);
+        const unsigned char* rotation = tables.rotation.data() + key * 128;
+        __m512i lane_keys = _mm512_maskz_permutexvar_epi8(
+            all, _mm512_maskz_expand_epi8(lowercase, ranks), _mm512_loadu_si512(rotation));
+        // slot of the key within its group in bits 5-6, letter in bits 0-4
+        __m512i index = _mm512_or_si512(
+            _mm512_slli_epi16(_mm512_and_si512(lane_keys, _mm512_set1_epi8(3)), 5),
+            _mm512_and_si512(c, _mm512_set1_epi8(31)));
+        __m512i lane_groups = _mm512_and_si512(_mm512_srli_epi16(lane_keys, 2), _mm512_set1_epi8(63));
+
+        __m512i substitute = _mm512_setzero_si512();
+        for (size_t g = 0; g < groups; ++g) {
+            const char* group = tables.by_low_bits.data() + g * 128;
+            __mmask64 own = _mm512_cmpeq_epi8_mask(lane_groups, _mm512_set1_epi8(static_cast<char>(g)));
+            substitute = _mm512_or_si512(substitute, _mm512_maskz_permutex2var_epi8(
+                own, _mm512_loadu_si512(group), index, _mm512_loadu_si512(group + 64)));
+        }
+        size_t count = __builtin_popcountll(lowercase);
+        key = rotation[count];
+
+        if (tables.passthrough) {
+            _mm512_storeu_si512(out + written, _mm512_mask_mov_epi8(c, lowercase, substitute));
+            written += 64;
+        } else {
+            _mm512_storeu_si512(out + written, _mm512_maskz_compress_epi8(lowercase, substitute));
+            written += count;
+        }
+    }
+    _mm256_zeroupper();
+    return written + substitute_sequence_scalar(tables, key, in + i, n - i, out + written);
+}
+
+#endif
+
+Substitution_kernel detect_kernel() {
+#ifdef SUBSTITUTION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi")
+        && __builtin_cpu_supports("avx512vbmi2"))
+        return AVX512_KERNEL;
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2_KERNEL;
+    if (__builtin_cpu_supports("ssse3"))
+        return SSSE3_KERNEL;
+#endif
+    return SCALAR_KERNEL;
+}
+
+// Largest amounts of keys in a sequence for which each vector kernel still
+// beats the scalar kernel; longer sequences go through the scalar kernel.
+const size_t SSSE3_MAX_KEYS = 16;
+const size_t AVX2_MAX_KEYS = 32;
+const size_t AVX512_MAX_KEYS = 128;
+
+size_t max_sequence_keys(Substitution_kernel kernel) {
+    switch (kernel) {
+    case SSSE3_KERNEL:
+        return SSSE3_MAX_KEYS;
+    case AVX2_KERNEL:
+        return AVX2_MAX_KEYS;
+    case AVX512_KERNEL:
+        return AVX512_MAX_KEYS;
+    default:
+        return 0;
+    }
+}
+
+}
+
+
+void compile_substitution(Substitution_tables& tables, const char* key, size_t key_length,
+                          bool passthrough) {
+    memset(&tables, 0, sizeof(tables));
+    tables.has_key = key_length != 0;
+    tables.passthrough = passthrough && tables.has_key;
+    if (tables.passthrough) {
+        for (int c = 0; c < 256; ++c)
+            tables.table[c] = static_cast<char>(c);
+    }
+    for (size_t i = 0; i < key_length; ++i) {
+        tables.table[static_cast<unsigned char>('a' + i)] = key[i];
+        tables.by_low_bits[('a' + i) & 63] = key[i];
+        if (i < 16)
+            tables.first_half[i] = key[i];
+        else
+            tables.second_half[i - 16] = key[i];
+    }
+}
+
+
+void compile_key_sequence(Key_sequence_tables& tables, const vector<string>& keys,
+                          bool passthrough) {
+    const size_t count = keys.size();
+    tables.keys.resize(count);
+    tables.table.assign(count * 256, 0);
+    tables.by_low_bits.assign((count + 3) / 4 * 128, 0);
+    tables.passthrough = passthrough;
+    for (size_t k = 0; k < count; ++k) {
+        const string& key = keys[k];
+        compile_substitution(tables.keys[k], key.data(), key.length(), passthrough);
+        memcpy(&tables.table[k * 256], tables.keys[k].table, 256);
+        for (size_t i = 0; i < key.length(); ++i)
+            tables.by_low_bits[k * 32 + (('a' + i) & 31)] = key[i];
+    }
+
+    tables.rotation.clear();
+    if (count <= max(max(SSSE3_MAX_KEYS, AVX2_MAX_KEYS), AVX512_MAX_KEYS)) {
+        tables.rotation.resize(count * 128);
+        for (size_t key = 0; key < count; ++key) {
+            for (size_t letters = 0; letters < 128; ++letters)
+                tables.rotation[key * 128 + letters] = static_cast<unsigned char>((key + letters) % count);
+        }
+    }
+}
+
+
+Substitution_kernel best_substitution_kernel() {
+    static const Substitution_kernel best = detect_kernel();
+    return best;
+}
+
+
+const char* substitution_kernel_name(Substitution_kernel kernel) {
+    switch (kernel) {
+    case SSSE3_KERNEL:
+        return "ssse3";
+    case AVX2_KERNEL:
+        return "avx2";
+    case AVX512_KERNEL:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+
+size_t substitute(Substitution_kernel kernel, const Substitution_tables& tables,
+                  const char* in, size_t n, char* out) {
+    if (!tables.has_key)
+        kernel = SCALAR_KERNEL;
+
+    if (tables.passthrough) {
+        switch (kernel) {
+#ifdef SUBSTITUTION_X86
+        case SSSE3_KERNEL:
+            return pass_through_ssse3(tables, in, n, out);
+        case AVX2_KERNEL:
+            return pass_through_avx2(tables, in, n, out);
+        case AVX512_KERNEL:
+            return pass_through_avx512(tables, in, n, out);
+#endif
+        default:
+            return pass_through_scalar(tables, in, n, out);
+        }
+    }
+
+    switch (kernel) {
+#ifdef SUBSTITUTION_X86
+    case SSSE3_KERNEL:
+        return substitute_ssse3(tables, in, n, out);
+    case AVX2_KERNEL:
+        return substitute_avx2(tables, in, n, out);
+    case AVX512_KERNEL:
+        return substitute_avx512(tables, in, n, out);
+#endif
+    default:
+        return substitute_scalar(tables, in, n, out);
+    }
+}
+
+
+size_t substitute(const Substitution_tables& tables, const char* in, size_t n, char* out) {
+    return substitute(best_substitution_kernel(), tables, in, n, out);
+}
+
+
+size_t substitute(Substitution_kernel kernel, const Key_sequence_tables& tables, size_t position,
+                  const char* in, size_t n, char* out) {
+    const size_t keys = tables.keys.size();
+    if (keys > max_sequence_keys(kernel))
+        kernel = SCALAR_KERNEL;
+
+    size_t key = position % keys;
+    switch (kernel) {
+#ifdef SUBSTITUTION_X86
+    case SSSE3_KERNEL:
+        return substitute_sequence_ssse3(tables, key, in, n, out);
+    case AVX2_KERNEL:
+        return substitute_sequence_avx2(tables, key, in, n, out);
+    case AVX512_KERNEL:
+        return substitute_sequence_avx512(tables, key, in, n, out);
+#endif
+    default:
+        return substitute_sequence_scalar(tables, key, in, n, out);
+    }
+}
+
+
+size_t substitute(const Key_sequence_tables& tables, size_t position,
+                  const char* in, size_t n, char* out) {
+    return substitute(best_substitution_kernel(), tables, position, in, n, out);
+}
+
+
+size_t count_letters(const char* in, size_t n) {
+    size_t letters = 0;
+    for (size_t i = 0; i < n; ++i)
+        letters += static_cast<unsigned char>(in[i] - 'a') < 26;
+    return letters;
+}
@@ -0,0 +1,175 @@
+/* Substitution
+ *
+ * Kernels that substitute letters a-z with a compiled key and either drop
+ * all other characters or pass them through unchanged. Besides the scalar
+ * kernel there are vector kernels for x86 (SSSE3 and AVX2 byte shuffles,
+ * AVX-512 VBMI byte permutes and compresses), and the best one the running
+ * CPU supports is picked once at run time. When dropping, every kernel
+ * gives exactly the same output as the function encrypt.
+ *
+ * A sequence of keys can also be compiled for polyalphabetic substitution,
+ * where the key rotates letter by letter like in a Vigenere cipher. Such
+ * sequences go through the same kernels, which look each block up with
+ * every key, as long as there are few enough keys for that to beat the
+ * scalar kernel.
+ */
+
+#ifndef SUBSTITUTION_HH
+#define SUBSTITUTION_HH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// A key compiled into the lookup tables used by the kernels.
+struct Substitution_tables {
+    // substitute of each character: itself for characters that are passed
+    // through, or 0 for characters that are dropped
+    char table[256];
+
+    // substitutes of a-z indexed by the six low bits of the letter, for
+    // 64-byte permutes
+    char by_low_bits[64];
+
+    // substitutes of a-p and q-z, for 16-byte shuffles
+    char first_half[16];
+    char second_half[16];
+
+    // false for an empty key, which drops every character; such tables
+    // always go through the scalar kernel
+    bool has_key;
+
+    // whether characters other than a-z are passed through
+    bool passthrough;
+};
+
+
+// A sequence of keys compiled for polyalphabetic substitution: letter i of
+// a text is substituted with key i % keys. Only the letters a-z move the
+// keys on, so the substitutes are the same whether the other characters are
+// dropped or passed through, and decrypting needs the letters only.
+struct Key_sequence_tables {
+    // tables of each key
+    vector<Substitution_tables> keys;
+
+    // substitutes of each character with each key, 256 per key, for the
+    // scalar kernel
+    vector<char> table;
+
+    // key of each of the next 128 letters after each key, 128 per key, for
+    // the vector kernels; empty with too many keys for them
+    vector<unsigned char> rotation;
+
+    // substitutes of a-z with each key indexed by the five low bits of the
+    // letter, 32 per key and padded to groups of four keys, for 128-byte
+    // permutes
+    vector<char> by_low_bits;
+
+    // whether characters other than a-z are passed through
+    bool passthrough;
+};
+
+
+enum Substitution_kernel {SCALAR_KERNEL, SSSE3_KERNEL, AVX2_KERNEL, AVX512_KERNEL};
+
+
+/**
+ * @brief compile_substitution compiles a key into lookup tables
+ * @param tables tables to be filled
+ * @param key valid encryption key (26 non-duplicate lowercase letters), or
+ * an empty key to drop every character
+ * @param key_length length of the key
+ * @param passthrough True to pass characters other than a-z through
+ * instead of dropping them; ignored with an empty key
+ */
+void compile_substitution(Substitution_tables& tables, const char* key, size_t key_length,
+                          bool passthrough = false);
+
+
+/**
+ * @brief compile_key_sequence compiles a sequence of keys into lookup tables
+ * @param tables tables to be filled
+ * @param keys valid encryption keys, at least one
+ * @param passthrough True to pass characters other than a-z through
+ * instead of dropping them
+ */
+void compile_key_sequence(Key_sequence_tables& tables, const vector<string>& keys,
+                          bool passthrough = false);
+
+
+/**
+ * @brief best_substitution_kernel finds the fastest kernel the running CPU supports
+ * @return kernel, detected on the first call only
+ */
+Substitution_kernel best_substitution_kernel();
+
+
+/**
+ * @brief substitution_kernel_name gives a kernel's name for printing
+ */
+const char* substitution_kernel_name(Substitution_kernel kernel);
+
+
+/**
+ * @brief substitute substitutes n characters from in to out with a given
+ * kernel. A kernel the CPU does not support must not be given. The same
+ * buffer may be given as in and out.
+ * @param kernel kernel to be used
+ * @param tables compiled key
+ * @param in characters to be substituted
+ * @param n amount of characters
+ * @param out buffer with room for n characters
+ * @return amount of characters written to out, which is n when passing
+ * characters through
+ */
+size_t substitute(Substitution_kernel kernel, const Substitution_tables& tables,
+                  const char* in, size_t n, char* out);
+
+
+/**
+ * @brief substitute substitutes n characters from in to out with the best
+ * kernel, like the above
+ */
+size_t substitute(const Substitution_tables& tables, const char* in, size_t n, char* out);
+
+
+
+/**
+ * @brief substitute substitutes n characters from in to out with a
+ * sequence of keys and a given kernel, like the above. The scalar kernel is
+ * used instead when there are too many keys for the given one.
+ * @param kernel kernel to be used
+ * @param tables compiled keys
+ * @param position amount of letters a-z before in in the whole text, which
+ * picks the key of the first letter
+ * @param in characters to be substituted
+ * @param n amount of characters
+ * @param out buffer with room for n characters
+ * @return amount of characters written to out
+ */
+size_t substitute(Substitution_kernel kernel, const Key_sequence_tables& tables, size_t position,
+                  const char* in, size_t n, char* out);
+
+
+/**
+ * @brief substitute substitutes n characters from in to out with a
+ * sequence of keys and the best kernel, like the above
+ */
+size_t substitute(const Key_sequence_tables& tables, size_t position,
+                  const char* in, size_t n, char* out);
+
+
+
+/**
+ * @brief count_letters counts the letters a-z, which move the keys of a
+ * sequence on
+ * @param in characters to be counted
+ * @param n amount of characters
+ * @return amount of letters
+ */
+size_t count_letters(const char* in, size_t n);
+
+#endif // SUBSTITUTION_HH
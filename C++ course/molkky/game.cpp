@@ -0,0 +1,236 @@
+/* Game
+*
+* A mölkky game of 2-8 players, who throw in turns in the order they were
+* given. A player who misses three times in a row is out of the game and
+* skipped from then on. The game ends when a player reaches exactly 50
+* points, or when all the other players are out. The rules are played in a
+* Game_state, which has no names and so can be copied without allocating,
+* as the game log does with the final state of each game; a Game adds the
+* names of the players, which are stored once, so a turn copies no names
+* and allocates nothing.
+*/
+
+#include "game.hh"
+#include <stdexcept>
+
+namespace
+{
+
+const int NO_WINNER = -1;
+
+}
+
+
+/**
+ * @brief start sets up a new game, the first player starts
+ * @param player_count amount of players, 2-8
+ */
+void Game_state::start(int player_count)
+{
+    *this = Game_state();
+    players = player_count;
+    remaining = player_count;
+}
+
+
+/**
+ * @brief add_throw scores a throw of the player in turn and moves the turn to
+ * the next player who is still in the game
+ * @param pts points of the throw, 0-12
+ * @return true if the game is over
+ */
+bool Game_state::add_throw(int pts)
+{
+    if(is_over())
+    {
+        return true;
+    }
+
+    ++throws;
+    points[in_turn] = points_after_throw(int(points[in_turn]), pts);
+    misses[in_turn] = pts == 0 ? misses[in_turn] + 1 : 0;
+    if(is_winning(int(points[in_turn])))
+    {
+        winner = in_turn;
+        return true;
+    }
+
+    if(is_out(misses[in_turn]))
+    {
+        --remaining;
+    }
+    do
+    {
+        in_turn = in_turn + 1 == players ? 0 : in_turn + 1;
+    }
+    while(is_out(misses[in_turn]));
+
+    // The player in turn is the only one left when all the others are out.
+    if(remaining == 1)
+    {
+        winner = in_turn;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief is_over checks if the game has a winner
+ * @return true = the game is over
+ */
+bool Game_state::is_over() const
+{
+    return winner != NO_WINNER;
+}
+
+
+/**
+ * @brief Game Constructor, the first player starts
+ * @param names names of the 2-8 players in the order of their turns
+ * @throw invalid_argument if the amount of players is out of range
+ */
+Game::Game(const vector<string>& names):
+    names_(names)
+{
+    if(names.size() < MIN_PLAYERS or names.size() > MAX_PLAYERS)
+    {
+        throw invalid_argument("Game: a game has 2-8 players");
+    }
+    state_.start(names.size());
+}
+
+
+/**
+ * @brief add_throw scores a throw of the player in turn and moves the turn to
+ * the next player who is still in the game
+ * @param pts points of the throw, 0-12
+ * @return true if the game is over
+ */
+bool Game::add_throw(int pts)
+{
+    return state_.add_throw(pts);
+}
+
+
+/**
+ * @brief reset starts a new game with the same players
+ */
+void Game::reset()
+{
+    state_.start(names_.size());
+}
+
+
+/**
+ * @brief get_players returns the amount of players, including those out of the game
+ * @return amount of players
+ */
+int Game::get_players() const
+{
+    return names_.size();
+}
+
+
+/**
+ * @brief get_name returns the name of a player
+ * @param index index of the player in the order of turns
+ * @return name of the player
+ */
+const string& Game::get_name(int index) const
+{
+    return names_.at(index);
+}
+
+
+/**
+ * @brief get_points returns the current points of a player
+ * @param index index of the player in the order of turns
+ * @return amount of points
+ */
+int Game::get_points(int index) const
+{
+    return state_.points[index];
+}
+
+
+/**
+ * @brief get_misses returns the misses in a row of a player
+ * @param index index of the player in the order of turns
+ * @return amount of misses, MAX_MISSES when the player is out
+ */
+int Game::get_misses(int index) const
+{
+    return state_.misses[index];
+}
+
+
+/**
+ * @brief is_eliminated checks if a player is out of the game
+ * @param index index of the player in the order of turns
+ * @return true = the player missed three times in a row
+ */
+bool Game::is_eliminated(int index) const
+{
+    return is_out(state_.misses[index]);
+}
+
+
+/**
+ * @brief get_player_in_turn returns the index of the player who throws next
+ * @return index of the player
+ */
+int Game::get_player_in_turn() const
+{
+    return state_.in_turn;
+}
+
+
+/**
+ * @brief get_turn returns the number of the current turn, starting from 1
+ * @return turn number
+ */
+int Game::get_turn() const
+{
+    return state_.throws + 1;
+}
+
+
+/**
+ * @brief get_remaining_players returns the amount of players still in the game
+ * @return amount of players
+ */
+int Game::get_remaining_players() const
+{
+    return state_.remaining;
+}
+
+
+/**
+ * @brief get_winner returns the index of the winner
+ * @return index of the winning player, or -1 if the game is not over
+ */
+int Game::get_winner() const
+{
+    return state_.winner;
+}
+
+
+/**
+ * @brief is_over checks if the game has a winner
+ * @return true = the game is over
+ */
+bool Game::is_over() const
+{
+    return state_.is_over();
+}
+
+
+/**
+ * @brief get_state returns the points, misses and turns of the game
+ * @return state of the game
+ */
+const Game_state& Game::get_state() const
+{
+    return state_;
+}
@@ -0,0 +1,54 @@
+#ifndef GAME_HH
+#define GAME_HH
+
+#include "rules.hh"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+// points, misses and turns of a game without the names of the players, so
+// that it can be copied without allocating
+struct Game_state
+{
+    int players = 0;
+    int throws = 0;
+    int in_turn = 0;
+    int remaining = 0;
+    int winner = -1;
+    unsigned char points[MAX_PLAYERS] = {};
+    unsigned char misses[MAX_PLAYERS] = {};
+
+    void start(int player_count);
+    bool add_throw(int pts);
+    bool is_over() const;
+};
+
+
+class Game
+{
+public:
+    Game(const vector<string>& names);
+
+    bool add_throw(int pts);
+    void reset();
+
+    int get_players() const;
+    const string& get_name(int index) const;
+    int get_points(int index) const;
+    int get_misses(int index) const;
+    bool is_eliminated(int index) const;
+    int get_player_in_turn() const;
+    int get_turn() const;
+    int get_remaining_players() const;
+    int get_winner() const;
+    bool is_over() const;
+    const Game_state& get_state() const;
+
+private:
+    vector<string> names_;
+    Game_state state_;
+};
+
+#endif // GAME_HH
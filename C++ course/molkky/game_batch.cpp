@@ -0,0 +1,212 @@
+/* Game batch
+*
+* Scores of many two- or more-player mölkky games that are played turn by
+* turn side by side, e.g. all the games of a league round. The points are
+* stored as arrays, one per player index, with a byte per game, and a turn
+* applies the throws of every game at once with the scoring rules of rules.hh:
+* the loop over the games has no branches, so the compiler vectorizes it.
+* Finished games ignore further throws. Misses do not put players out.
+*/
+
+#include "game_batch.hh"
+#include "rules.hh"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+const unsigned char NO_WINNER = 0xff;
+
+// The games are handled in blocks of a fixed size, a loop the compiler
+// vectorizes, and the games after the last whole block one at a time.
+const size_t BLOCK_SIZE = 64;
+
+/**
+ * @brief apply_throw adds a throw to a player's points unless the game
+ * already has a winner, and makes the player the winner with 50 points. The
+ * choices are made with masks instead of branches.
+ * @return 1 if the game has a winner after the throw, otherwise 0
+ */
+inline unsigned char apply_throw(unsigned char& pts, unsigned char& winner, unsigned char throw_pts,
+                                 unsigned char player)
+{
+    unsigned char playing = -static_cast<unsigned char>(winner == NO_WINNER);
+    unsigned char after = points_after_throw(pts, throw_pts);
+    unsigned char won = playing & -static_cast<unsigned char>(is_winning(after));
+    pts = (after & playing) | (pts & ~playing);
+    winner = (player & won) | (winner & ~won);
+    return winner != NO_WINNER;
+}
+
+/**
+ * @brief checked_players checks an amount of players before the points are
+ * allocated for them
+ * @return the amount of players
+ * @throw invalid_argument if it is out of range
+ */
+int checked_players(int players)
+{
+    if(players < MIN_PLAYERS or players > MAX_PLAYERS)
+    {
+        throw invalid_argument("Game_batch: a game has 2-8 players");
+    }
+    return players;
+}
+
+}
+
+
+/**
+ * @brief Game_batch creates games with every player at 0 points
+ * @param games amount of games
+ * @param players amount of players in each game, 2-8
+ * @throw invalid_argument if the amount of players is out of range
+ */
+Game_batch::Game_batch(size_t games, int players):
+    games_(games),
+    players_(checked_players(players)),
+    turn_(0),
+    finished_games_(0),
+    points_(games * players_, 0),
+    winners_(games, NO_WINNER)
+{
+}
+
+
+/**
+ * @brief apply_turn adds the throw of the player in turn in every game
+ * @param throws points of the throw in each game, 0-12
+ * @throw invalid_argument if there is not one throw per game
+ */
+void Game_batch::apply_turn(const vector<unsigned char>& throws)
+{
+    if(throws.size() != games_)
+    {
+        throw invalid_argument("Game_batch: a turn needs one throw per game");
+    }
+    apply_turn(throws.data());
+}
+
+
+/**
+ * @brief apply_turn adds the throw of the player in turn in every game
+ * @param throws points of the throw in each game, 0-12, get_games() of them
+ */
+void Game_batch::apply_turn(const unsigned char* throws)
+{
+    const unsigned char player = static_cast<unsigned char>(get_player_in_turn());
+    unsigned char* points = points_.data() + player * games_;
+    unsigned char* winners = winners_.data();
+
+    size_t finished = 0;
+    size_t game = 0;
+    for(; game + BLOCK_SIZE <= games_; game += BLOCK_SIZE)
+    {
+        // The block is copied to local arrays, which the compiler knows
+        // not to overlap, and counted in a byte, the size of the lanes.
+        unsigned char block_points[BLOCK_SIZE];
+        unsigned char block_winners[BLOCK_SIZE];
+        unsigned char block_throws[BLOCK_SIZE];
+        copy(points + game, points + game + BLOCK_SIZE, block_points);
+        copy(winners + game, winners + game + BLOCK_SIZE, block_winners);
+        copy(throws + game, throws + game + BLOCK_SIZE, block_throws);
+        unsigned char block_finished = 0;
+        for(size_t i = 0; i < BLOCK_SIZE; ++i)
+        {
+            block_finished += apply_throw(block_points[i], block_winners[i], block_throws[i], player);
+        }
+        copy(block_points, block_points + BLOCK_SIZE, points + game);
+        copy(block_winners, block_winners + BLOCK_SIZE, winners + game);
+        finished += block_finished;
+    }
+    for(; game < games_; ++game)
+    {
+        finished += apply_throw(points[game], winners[game], throws[game], player);
+    }
+
+    finished_games_ = finished;
+    ++turn_;
+}
+
+
+/**
+ * @brief reset starts all the games over
+ */
+void Game_batch::reset()
+{
+    fill(points_.begin(), points_.end(), 0);
+    fill(winners_.begin(), winners_.end(), NO_WINNER);
+    turn_ = 0;
+    finished_games_ = 0;
+}
+
+
+/**
+ * @brief get_games returns the amount of games
+ */
+size_t Game_batch::get_games() const
+{
+    return games_;
+}
+
+
+/**
+ * @brief get_players returns the amount of players in each game
+ */
+int Game_batch::get_players() const
+{
+    return players_;
+}
+
+
+/**
+ * @brief get_turn returns the amount of turns played
+ */
+int Game_batch::get_turn() const
+{
+    return turn_;
+}
+
+
+/**
+ * @brief get_player_in_turn returns the index of the player whose throws the
+ * next turn applies
+ */
+int Game_batch::get_player_in_turn() const
+{
+    return turn_ % players_;
+}
+
+
+/**
+ * @brief get_points returns the current points of a player in a game
+ * @param game index of the game
+ * @param player index of the player
+ * @return amount of points
+ */
+int Game_batch::get_points(size_t game, int player) const
+{
+    return points_.at(player * games_ + game);
+}
+
+
+/**
+ * @brief get_winner returns the winner of a game
+ * @param game index of the game
+ * @return index of the player who won, or -1 if the game goes on
+ */
+int Game_batch::get_winner(size_t game) const
+{
+    unsigned char winner = winners_.at(game);
+    return winner == NO_WINNER ? -1 : winner;
+}
+
+
+/**
+ * @brief get_finished_games returns the amount of games that have a winner
+ */
+size_t Game_batch::get_finished_games() const
+{
+    return finished_games_;
+}
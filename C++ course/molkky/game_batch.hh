@@ -0,0 +1,39 @@
+#ifndef GAME_BATCH_HH
+#define GAME_BATCH_HH
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+
+class Game_batch
+{
+public:
+    Game_batch(size_t games, int players);
+
+    void apply_turn(const vector<unsigned char>& throws);
+    void apply_turn(const unsigned char* throws);
+    void reset();
+
+    size_t get_games() const;
+    int get_players() const;
+    int get_turn() const;
+    int get_player_in_turn() const;
+    int get_points(size_t game, int player) const;
+    int get_winner(size_t game) const;
+    size_t get_finished_games() const;
+
+private:
+    size_t games_;
+    int players_;
+    int turn_;
+    size_t finished_games_;
+
+    // points of each player in each game, points_[player * games_ + game]
+    vector<unsigned char> points_;
+    // NO_WINNER or the index of the winner of each game
+    vector<unsigned char> winners_;
+};
+
+#endif // GAME_BATCH_HH
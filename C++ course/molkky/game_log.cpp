@@ -0,0 +1,513 @@
+/* Game log
+*
+* Append-only binary log of the events of mölkky games, from which the state
+* of any game, or its state after any amount of throws, can be rebuilt. The
+* events of many games may be interleaved. The log starts with a header:
+*     magic "MOLKKLOG", version 2 as a 32-bit little-endian number, 4 zeros
+* followed by records of 8 bytes:
+*     game number (32-bit little endian), kind, value, 2 data bytes
+* A game starts with a start record whose value is the amount of players.
+* Name records follow it, at least one for each player in turn order, whose
+* value is the index of the player and whose data bytes are the next two
+* characters of the name, or zeros past its end. Then there is a throw
+* record for each throw, whose value is its points and whose data bytes are
+* zeros. Version 1 logs have no name records and are still read; their
+* players are named by their turn, Player 1, Player 2 and so on.
+*
+* A log may end in a partial record if the program was stopped while it
+* was writing. Loading ignores such a record with a warning, and a log is
+* cut back to its whole records with truncate_log before appending to it.
+*
+* Loading a log replays every game once to check it and keeps the final
+* state of each game. It also links each record to the next record of the
+* same game, so that replaying a game to one of its throws scans only the
+* records of that game from its start.
+*/
+
+#include "game_log.hh"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define GAME_LOG_TRUNCATE 1
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace
+{
+
+const char MAGIC[8] = {'M', 'O', 'L', 'K', 'K', 'L', 'O', 'G'};
+const uint32_t VERSION = 2;
+const uint32_t FIRST_VERSION = 1;
+const size_t HEADER_SIZE = 16;
+const size_t RECORD_SIZE = 8;
+
+const unsigned char START = 0;
+const unsigned char THROW = 1;
+const unsigned char NAME = 2;
+
+// bytes buffered by a writer before they are written
+const size_t WRITE_BUFFER_SIZE = 1 << 16;
+const size_t READ_BLOCK_SIZE = 1 << 20;
+
+// The records are linked with 32-bit numbers.
+const size_t MAX_RECORDS = UINT32_MAX;
+
+const char* const NOT_A_LOG_ERROR = "Error! The file is not a game log.";
+const char* const PARTIAL_RECORD_WARNING =
+        "Warning! The game log ends in a partial record, which is ignored.";
+const char* const READ_ERROR = "Error! The game log cannot be read.";
+const char* const TOO_LONG_ERROR = "Error! The game log is too long.";
+
+void put_u32(char* bytes, uint32_t value)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+uint32_t get_u32(const char* bytes)
+{
+    uint32_t value = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        value |= uint32_t(static_cast<unsigned char>(bytes[i])) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief record_error prints an error about a record to cerr
+ * @return false
+ */
+bool record_error(size_t record, uint32_t game, const char* error)
+{
+    cerr << "Error! Record " << record << " of game " << game << " " << error << "." << endl;
+    return false;
+}
+
+}
+
+
+/**
+ * @brief Game_log_writer Constructor, writes the header of the log if the
+ * file is empty and otherwise appends to its end
+ * @param out log file, opened for appending
+ */
+Game_log_writer::Game_log_writer(FILE* out):
+    out_(out),
+    ok_(true)
+{
+    buffer_.reserve(WRITE_BUFFER_SIZE);
+    if(fseek(out_, 0, SEEK_END) == 0 and ftell(out_) == 0)
+    {
+        buffer_.insert(buffer_.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        buffer_.resize(HEADER_SIZE, '\0');
+        put_u32(&buffer_[sizeof(MAGIC)], VERSION);
+    }
+}
+
+
+Game_log_writer::~Game_log_writer()
+{
+    flush();
+}
+
+
+/**
+ * @brief start_game appends the start of a game and the names of its players
+ * @param game number of the game, not used before in the log
+ * @param names names of the 2-8 players in the order of their turns
+ * @return false if the amount of players or a name is invalid or writing
+ * failed
+ */
+bool Game_log_writer::start_game(uint32_t game, const vector<string>& names)
+{
+    if(names.size() < MIN_PLAYERS or names.size() > MAX_PLAYERS)
+    {
+        return false;
+    }
+    for(const string& name : names)
+    {
+        if(name.find('\0') != string::npos)
+        {
+            return false;
+        }
+    }
+    append(game, START, static_cast<unsigned char>(names.size()));
+    for(size_t player = 0; player < names.size(); ++player)
+    {
+        // An empty name still gets a record, so that every player has one.
+        const string& name = names[player];
+        size_t i = 0;
+        do
+        {
+            append(game, NAME, static_cast<unsigned char>(player), i < name.size() ? name[i] : '\0',
+                   i + 1 < name.size() ? name[i + 1] : '\0');
+            i += 2;
+        }
+        while(i < name.size());
+    }
+    return ok_;
+}
+
+
+/**
+ * @brief add_throw appends a throw of the player in turn in a game
+ * @param game number of the game
+ * @param pts points of the throw, 0-12
+ * @return false if the points are invalid or writing failed
+ */
+bool Game_log_writer::add_throw(uint32_t game, int pts)
+{
+    if(pts < 0 or pts > MAX_THROW_POINTS)
+    {
+        return false;
+    }
+    append(game, THROW, static_cast<unsigned char>(pts));
+    return ok_;
+}
+
+
+/**
+ * @brief flush writes the buffered records to the file
+ * @return false if writing has failed
+ */
+bool Game_log_writer::flush()
+{
+    if(not buffer_.empty())
+    {
+        ok_ = fwrite(buffer_.data(), 1, buffer_.size(), out_) == buffer_.size() and ok_;
+        buffer_.clear();
+    }
+    ok_ = fflush(out_) == 0 and ok_;
+    return ok_;
+}
+
+
+void Game_log_writer::append(uint32_t game, unsigned char kind, unsigned char value, char first,
+                             char second)
+{
+    if(buffer_.size() + RECORD_SIZE > WRITE_BUFFER_SIZE)
+    {
+        ok_ = fwrite(buffer_.data(), 1, buffer_.size(), out_) == buffer_.size() and ok_;
+        buffer_.clear();
+    }
+    char record[RECORD_SIZE] = {};
+    put_u32(record, game);
+    record[4] = static_cast<char>(kind);
+    record[5] = static_cast<char>(value);
+    record[6] = first;
+    record[7] = second;
+    buffer_.insert(buffer_.end(), record, record + RECORD_SIZE);
+}
+
+
+Game_log::Game_log():
+    throws_(0),
+    next_game_(0),
+    partial_record_(false)
+{
+}
+
+
+/**
+ * @brief load reads a log to its end and replays all its games. The first
+ * error is printed to cerr, and so is a warning if the log ends in a partial
+ * record, which is ignored.
+ * @param in log file
+ * @return false if the file is not a valid log or cannot be read
+ */
+bool Game_log::load(FILE* in)
+{
+    records_.clear();
+    next_records_.clear();
+    games_.clear();
+    throws_ = 0;
+    next_game_ = 0;
+    partial_record_ = false;
+
+    char header[HEADER_SIZE];
+    if(fread(header, 1, HEADER_SIZE, in) != HEADER_SIZE or memcmp(header, MAGIC, sizeof(MAGIC)) != 0
+            or get_u32(header + 8) < FIRST_VERSION or get_u32(header + 8) > VERSION)
+    {
+        cerr << (ferror(in) ? READ_ERROR : NOT_A_LOG_ERROR) << endl;
+        return false;
+    }
+    // The records are read in blocks. When the size of the file is known,
+    // the first block is a byte larger than the rest of the file, so that it
+    // is read at once.
+    size_t block = READ_BLOCK_SIZE;
+    long start = ftell(in);
+    if(start >= 0 and fseek(in, 0, SEEK_END) == 0)
+    {
+        long end = ftell(in);
+        if(end >= start and fseek(in, start, SEEK_SET) == 0)
+        {
+            block = end - start + 1;
+        }
+    }
+    size_t read = 0;
+    do
+    {
+        records_.resize(records_.size() + block);
+        read = fread(&records_[records_.size() - block], 1, block, in);
+        records_.resize(records_.size() - block + read);
+        block = read == block ? READ_BLOCK_SIZE : 0;
+    }
+    while(block != 0);
+    if(ferror(in))
+    {
+        cerr << READ_ERROR << endl;
+        return false;
+    }
+    if(records_.size() % RECORD_SIZE != 0)
+    {
+        cerr << PARTIAL_RECORD_WARNING << endl;
+        records_.resize(records_.size() - records_.size() % RECORD_SIZE);
+        partial_record_ = true;
+    }
+    if(records_.size() / RECORD_SIZE > MAX_RECORDS)
+    {
+        cerr << TOO_LONG_ERROR << endl;
+        return false;
+    }
+
+    // Consecutive records often belong to the same game, which is then
+    // looked up once.
+    const size_t records = records_.size() / RECORD_SIZE;
+    next_records_.resize(records);
+    Game_info* info = nullptr;
+    uint32_t info_game = 0;
+    for(size_t record = 0; record < records; ++record)
+    {
+        const char* bytes = &records_[record * RECORD_SIZE];
+        uint32_t game = get_u32(bytes);
+        unsigned char kind = bytes[4];
+        int value = static_cast<unsigned char>(bytes[5]);
+
+        if(kind == START)
+        {
+            if(value < MIN_PLAYERS or value > MAX_PLAYERS)
+            {
+                return record_error(record, game, "has an invalid amount of players");
+            }
+            if(not games_.emplace(game, Game_info{record, record, Game_state(), {}}).second)
+            {
+                return record_error(record, game, "starts the game again");
+            }
+            info = &games_[game];
+            info_game = game;
+            info->state.start(value);
+            info->names.resize(value);
+            next_game_ = max(next_game_, game + 1);
+            continue;
+        }
+
+        if(info == nullptr or info_game != game)
+        {
+            auto found = games_.find(game);
+            info = found == games_.end() ? nullptr : &found->second;
+            info_game = game;
+        }
+        if(kind == NAME)
+        {
+            if(info == nullptr)
+            {
+                return record_error(record, game, "is a name before the game starts");
+            }
+            if(value >= info->state.players)
+            {
+                return record_error(record, game, "is invalid");
+            }
+            if(info->state.throws != 0)
+            {
+                return record_error(record, game, "is a name after the first throw");
+            }
+            for(int i = 6; i < 8 and bytes[i] != '\0'; ++i)
+            {
+                info->names[value] += bytes[i];
+            }
+            continue;
+        }
+        if(kind != THROW or value > MAX_THROW_POINTS)
+        {
+            return record_error(record, game, "is invalid");
+        }
+        if(info == nullptr)
+        {
+            return record_error(record, game, "is a throw before the game starts");
+        }
+        if(info->state.is_over())
+        {
+            return record_error(record, game, "is a throw after the game is over");
+        }
+
+        info->state.add_throw(value);
+        next_records_[info->last_record] = record;
+        info->last_record = record;
+        ++throws_;
+    }
+    return true;
+}
+
+
+/**
+ * @brief get_games returns the amount of games in the log
+ * @return amount of games
+ */
+size_t Game_log::get_games() const
+{
+    return games_.size();
+}
+
+
+/**
+ * @brief get_throws returns the amount of throws in the log
+ * @return amount of throws
+ */
+size_t Game_log::get_throws() const
+{
+    return throws_;
+}
+
+
+/**
+ * @brief get_next_game returns a number for a new game
+ * @return one more than the largest game number in the log
+ */
+uint32_t Game_log::get_next_game() const
+{
+    return next_game_;
+}
+
+
+/**
+ * @brief get_size returns the size of the log without a partial record at
+ * its end
+ * @return size in bytes
+ */
+size_t Game_log::get_size() const
+{
+    return HEADER_SIZE + records_.size();
+}
+
+
+/**
+ * @brief has_partial_record checks if the log ended in a partial record,
+ * which load ignored
+ * @return true = the file is longer than get_size()
+ */
+bool Game_log::has_partial_record() const
+{
+    return partial_record_;
+}
+
+
+/**
+ * @brief get_names gives the names of the players of a game
+ * @param game number of the game
+ * @param names set to the names in the order of the turns; players without
+ * a name are named by their turn, Player 1, Player 2 and so on
+ * @return false if the game is not in the log
+ */
+bool Game_log::get_names(uint32_t game, vector<string>& names) const
+{
+    auto found = games_.find(game);
+    if(found == games_.end())
+    {
+        return false;
+    }
+    names = found->second.names;
+    for(size_t player = 0; player < names.size(); ++player)
+    {
+        if(names[player].empty())
+        {
+            names[player] = "Player " + to_string(player + 1);
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief replay gives the state of a game after all its throws in the log
+ * @param game number of the game
+ * @param state set to the state
+ * @return false if the game is not in the log
+ */
+bool Game_log::replay(uint32_t game, Game_state& state) const
+{
+    auto found = games_.find(game);
+    if(found == games_.end())
+    {
+        return false;
+    }
+    state = found->second.state;
+    return true;
+}
+
+
+/**
+ * @brief replay rebuilds the state of a game after its first throws by
+ * playing them from the start of the game
+ * @param game number of the game
+ * @param throws amount of throws; all the throws in the log if it has fewer
+ * @param state set to the state
+ * @return false if the game is not in the log
+ */
+bool Game_log::replay(uint32_t game, int throws, Game_state& state) const
+{
+    auto found = games_.find(game);
+    if(found == games_.end())
+    {
+        return false;
+    }
+    const Game_info& info = found->second;
+    if(throws >= info.state.throws)
+    {
+        state = info.state;
+        return true;
+    }
+
+    size_t record = info.first_record;
+    state.start(records_[record * RECORD_SIZE + 5]);
+    while(state.throws < throws)
+    {
+        record = next_records_[record];
+        state.add_throw(records_[record * RECORD_SIZE + 5]);
+    }
+    return true;
+}
+
+
+/**
+ * @brief truncate_log cuts a log file to its whole records, so that records
+ * appended to it start at a record boundary
+ * @param path path of the log
+ * @param size size of the whole records, get_size() of the loaded log
+ * @return false if the file cannot be cut
+ */
+bool truncate_log(const string& path, size_t size)
+{
+#ifdef GAME_LOG_TRUNCATE
+    return truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+#else
+    // Without truncate the whole records are written over the file.
+    ifstream in(path, ios::binary);
+    vector<char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    if(not in.eof() or bytes.size() < size)
+    {
+        return false;
+    }
+    in.close();
+    ofstream out(path, ios::binary | ios::trunc);
+    out.write(bytes.data(), size);
+    return static_cast<bool>(out.flush());
+#endif
+}
@@ -0,0 +1,72 @@
+#ifndef GAME_LOG_HH
+#define GAME_LOG_HH
+
+#include "game.hh"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+
+class Game_log_writer
+{
+public:
+    Game_log_writer(FILE* out);
+    ~Game_log_writer();
+
+    bool start_game(uint32_t game, const vector<string>& names);
+    bool add_throw(uint32_t game, int pts);
+    bool flush();
+
+private:
+    void append(uint32_t game, unsigned char kind, unsigned char value, char first = '\0',
+                char second = '\0');
+
+    FILE* out_;
+    vector<char> buffer_;
+    bool ok_;
+};
+
+
+class Game_log
+{
+public:
+    Game_log();
+
+    bool load(FILE* in);
+
+    size_t get_games() const;
+    size_t get_throws() const;
+    uint32_t get_next_game() const;
+    size_t get_size() const;
+    bool has_partial_record() const;
+    bool get_names(uint32_t game, vector<string>& names) const;
+    bool replay(uint32_t game, Game_state& state) const;
+    bool replay(uint32_t game, int throws, Game_state& state) const;
+
+private:
+    struct Game_info
+    {
+        size_t first_record;
+        size_t last_record;
+        Game_state state;
+        vector<string> names;
+    };
+
+    vector<char> records_;
+    // the next record of the same game after each record
+    vector<uint32_t> next_records_;
+    unordered_map<uint32_t, Game_info> games_;
+    size_t throws_;
+    uint32_t next_game_;
+    bool partial_record_;
+};
+
+
+bool truncate_log(const string& path, size_t size);
+
+#endif // GAME_LOG_HH
@@ -1,8 +1,10 @@
 /* Molkky
 * 
 * Introductory exercise to small classes and pointers in C++.
-* Cmd line based program that can be used as a point counter in mölkky with 2 players.
-* In this game the players are named Matti and Teppo.
+* Cmd line based program that can be used as a point counter in mölkky with 2-8 players.
+* The players are named on the command line, in the order of their turns:
+*     molkky [NAME NAME ...]
+* Without names the players are named Matti and Teppo.
 * 
 * Mölkky is a block throwing game where your aim is to get exactly 50 points. 
 * If a player gets more than 50 points, their score is reduced to 25 points.
@@ -10,53 +12,377 @@
 * Each turn, the user can input the amount of points scored. After that, the program
 * will print out the scoreboard. Points are automatically reduced to 25 if the player 
 * reaches more than 50 points.
-* When either player reaches exactly 50 points, the program will announce the winner.
+* A player who misses all the pins three times in a row is out of the game.
+* When a player reaches exactly 50 points, or all the other players are out,
+* the program will announce the winner. In a game of two the scoreboard also
+* shows the chances of each player to win, as if both threw with the
+* greedy:0.5 model below.
+*
+* With --log FILE before the names, the names and the throws of the game are
+* appended to a game log, under the next free game number. --replay rebuilds
+* a game of a log, after all its throws or after the given amount of them:
+*     molkky --log FILE [NAME NAME ...]
+*     molkky --replay FILE GAME [THROWS]
+*
+* With --simulate GAMES the program instead plays the given amount of games
+* between two throw models on all the cores and prints the win probabilities:
+*     molkky --simulate GAMES [--first MODEL] [--second MODEL]
+*            [--threads N] [--seed S] [--max-turns N]
+* A model is uniform, greedy[:ACCURACY] or setup[:ACCURACY]. The first
+* player always starts. The results only depend on the seed.
 */
 
-#include "player.hh"
+#include "game.hh"
+#include "game_log.hh"
+#include "rules.hh"
+#include "simulation.hh"
+#include "win_table.hh"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
+
+
+void print_usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--log FILE] [NAME NAME ...]" << std::endl
+              << "       " << program << " --replay FILE GAME [THROWS]" << std::endl
+              << "       " << program << " --simulate GAMES [--first MODEL] [--second MODEL]"
+              << " [--threads N] [--seed S] [--max-turns N]" << std::endl
+              << "MODEL is uniform, greedy[:ACCURACY] or setup[:ACCURACY]" << std::endl;
+}
+
+
+bool parse_number(const char* str, unsigned long long& number)
+{
+    char* end = nullptr;
+    number = std::strtoull(str, &end, 10);
+    return end != str and *end == '\0' and str[0] != '-';
+}
+
+
+// Prints a share of the games as a percentage with its 95 % confidence interval.
+void print_share(const std::string& label, std::size_t count, std::size_t games)
+{
+    double share = static_cast<double>(count) / games;
+    double margin = 1.96 * std::sqrt(share * (1 - share) / games);
+    std::cout << label << std::fixed << std::setprecision(2) << 100 * share
+              << " % (+- " << 100 * margin << " %)" << std::endl;
+}
+
+
+int simulate_games(int argc, char* argv[])
+{
+    unsigned long long games = 0;
+    std::string first_description = "greedy";
+    std::string second_description = "greedy";
+    Simulation_options options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        unsigned long long number = 0;
+        if (i + 1 == argc)
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        const char* value = argv[++i];
+        if (arg == "--first")
+        {
+            first_description = value;
+        }
+        else if (arg == "--second")
+        {
+            second_description = value;
+        }
+        else if (not parse_number(value, number))
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else if (arg == "--simulate" and number > 0)
+        {
+            games = number;
+        }
+        else if (arg == "--threads" and number > 0 and number <= 1024)
+        {
+            options.threads = number;
+        }
+        else if (arg == "--seed")
+        {
+            options.seed = number;
+        }
+        else if (arg == "--max-turns" and number > 0 and number <= 1000000)
+        {
+            options.max_turns = number;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Throw_model first = Throw_model::uniform();
+    Throw_model second = Throw_model::uniform();
+    if (games == 0 or not Throw_model::parse(first_description, first)
+            or not Throw_model::parse(second_description, second))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Simulation_result result = simulate(first, second, games, options);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Simulated " << result.games << " games in " << std::fixed
+              << std::setprecision(3) << elapsed.count() << " s on " << options.threads
+              << " threads (" << std::setprecision(0) << result.games / elapsed.count()
+              << " games per second)" << std::endl;
+    print_share("First player (" + first_description + ") wins: ", result.first_wins, result.games);
+    print_share("Second player (" + second_description + ") wins: ", result.second_wins, result.games);
+    if (result.unfinished != 0)
+    {
+        print_share("Unfinished after " + std::to_string(options.max_turns) + " turns: ",
+                    result.unfinished, result.games);
+    }
+    return EXIT_SUCCESS;
+}
+
+
+// Prints the points of the players after a turn, with their misses in a row
+// and, in a game of two, their chances to win.
+void print_scoreboard(const Game& game, const Win_table& win_table)
+{
+    std::cout << std::endl;
+    std::cout << "Scoreboard after turn " << game.get_turn() - 1 << ":" << std::endl;
+    for (int i = 0; i < game.get_players(); ++i)
+    {
+        std::cout << game.get_name(i) << ": " << game.get_points(i) << "p";
+        if (game.is_eliminated(i))
+        {
+            std::cout << ", out";
+        }
+        else if (game.get_misses(i) > 0)
+        {
+            std::cout << ", " << game.get_misses(i) << (game.get_misses(i) == 1 ? " miss" : " misses");
+        }
+        if (game.get_players() == 2)
+        {
+            // The player of the next turn is in turn in the table.
+            double probability = win_table.get_win_probability(i, game.get_points(0), game.get_points(1),
+                                                               game.get_misses(0), game.get_misses(1),
+                                                               game.get_player_in_turn());
+            std::cout << " (" << std::fixed << std::setprecision(1) << 100 * probability << " % to win)";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+
+int replay_game(int argc, char* argv[])
+{
+    unsigned long long game_number = 0;
+    unsigned long long throws = 0;
+    if (argc < 4 or argc > 5 or not parse_number(argv[3], game_number)
+            or (argc == 5 and not parse_number(argv[4], throws)))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* in = std::fopen(argv[2], "rb");
+    if (in == nullptr)
+    {
+        std::cerr << "Error! The game log cannot be opened." << std::endl;
+        return EXIT_FAILURE;
+    }
+    Game_log log;
+    bool loaded = log.load(in);
+    std::fclose(in);
+    if (not loaded)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Game numbers are 32-bit, so a larger one is checked before it is
+    // narrowed, or it could wrap around to a game that is in the log.
+    Game_state state;
+    bool found = game_number <= UINT32_MAX
+            and (argc == 5 ? log.replay(game_number, std::min(throws, 1ULL << 30), state)
+                           : log.replay(game_number, state));
+    if (not found)
+    {
+        std::cerr << "Error! Game " << game_number << " is not in the log." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> names;
+    log.get_names(game_number, names);
+    std::cout << "Game " << game_number << " after " << state.throws << " throws:" << std::endl;
+    for (int i = 0; i < state.players; ++i)
+    {
+        std::cout << names[i] << ": " << int(state.points[i]) << "p";
+        if (is_out(state.misses[i]))
+        {
+            std::cout << ", out";
+        }
+        else if (state.misses[i] > 0)
+        {
+            std::cout << ", " << int(state.misses[i]) << (state.misses[i] == 1 ? " miss" : " misses");
+        }
+        std::cout << std::endl;
+    }
+    if (state.is_over())
+    {
+        std::cout << "The winner is " << names[state.winner] << "!" << std::endl;
+    }
+    else
+    {
+        std::cout << names[state.in_turn] << " is in turn." << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
 
 
-int main()
+// Opens a game log for appending a game, and finds the number of the game. A
+// partial record at the end of the log, left by a program that was stopped
+// while writing, is cut off first.
+FILE* open_log(const std::string& path, std::uint32_t& game_number)
 {
-    Player player1 = Player("Matti");
-    Player player2 = Player("Teppo");
-    Player* in_turn = 0;
+    game_number = 0;
+    FILE* existing = std::fopen(path.c_str(), "rb");
+    if (existing != nullptr)
+    {
+        bool empty = std::fgetc(existing) == EOF;
+        std::rewind(existing);
+        Game_log log;
+        bool loaded = empty or log.load(existing);
+        std::fclose(existing);
+        if (not loaded)
+        {
+            return nullptr;
+        }
+        if (log.has_partial_record() and not truncate_log(path, log.get_size()))
+        {
+            std::cerr << "Error! The partial record cannot be cut off the game log." << std::endl;
+            return nullptr;
+        }
+        game_number = log.get_next_game();
+    }
+
+    FILE* out = std::fopen(path.c_str(), "ab");
+    if (out == nullptr)
+    {
+        std::cerr << "Error! The game log cannot be opened." << std::endl;
+    }
+    return out;
+}
 
-    int turn = 1;
+
+int main(int argc, char* argv[])
+{
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--replay")
+    {
+        return replay_game(argc, argv);
+    }
+    int first_name = 1;
+    if (mode == "--log" and argc > 2)
+    {
+        first_name = 3;
+    }
+    else if (argc > 1 and argv[1][0] == '-')
+    {
+        return simulate_games(argc, argv);
+    }
+
+    std::vector<std::string> names(argv + first_name, argv + argc);
+    if (names.empty())
+    {
+        names = {"Matti", "Teppo"};
+    }
+    if (names.size() < MIN_PLAYERS or names.size() > MAX_PLAYERS)
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    Game game(names);
+
+    // The throws are logged as they are entered, so that the log has the
+    // game even if it is not finished. The writer is destroyed before the
+    // file, so it flushes its last records on every return.
+    std::unique_ptr<FILE, int (*)(FILE*)> log_file(nullptr, std::fclose);
+    std::unique_ptr<Game_log_writer> log;
+    std::uint32_t game_number = 0;
+    if (first_name == 3)
+    {
+        log_file.reset(open_log(argv[2], game_number));
+        if (log_file == nullptr)
+        {
+            return EXIT_FAILURE;
+        }
+        log.reset(new Game_log_writer(log_file.get()));
+        if (not (log->start_game(game_number, names) and log->flush()))
+        {
+            std::cerr << "Error! The game cannot be logged." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Logging game " << game_number << " to " << argv[2] << std::endl;
+    }
+
+    const Throw_model model = Throw_model::greedy(0.5);
+    const Win_table win_table(model, model);
+
+    int result = EXIT_SUCCESS;
     while (true)
     {
-      if (turn % 2 != 0)
+      const int in_turn = game.get_player_in_turn();
+      std::cout << "Enter the score of player " << game.get_name(in_turn)
+                << " of turn " << game.get_turn() << ": ";
+      int pts = 0;
+      if (not (std::cin >> pts))
       {
-          in_turn = &player1;
+          result = EXIT_FAILURE;
+          break;
       }
-      else
+      if (pts < 0 or pts > MAX_THROW_POINTS)
       {
-          in_turn = &player2;
+          std::cout << "A throw scores 0-" << MAX_THROW_POINTS << " points." << std::endl;
+          continue;
       }
-
-      std::cout << "Enter the score of player " << in_turn->get_name()
-                << " of turn " << turn << ": ";
-      int pts = 0;
-      std::cin >> pts;
-
-      in_turn->add_points(pts);
-      if (in_turn->has_won())
+      if (log != nullptr and not (log->add_throw(game_number, pts) and log->flush()))
       {
-          std::cout << "Game over! The winner is " << in_turn->get_name() << "!" << std::endl;
-          return EXIT_SUCCESS;
+          std::cerr << "Error! The throw cannot be logged." << std::endl;
+          result = EXIT_FAILURE;
+          break;
       }
 
-      std::cout << std::endl;
-      std::cout << "Scoreboard after turn " << turn << ":" << std::endl;
-      std::cout << player1.get_name() << ": " << player1.get_points() << "p" << std::endl;
-      std::cout << player2.get_name() << ": " << player2.get_points() << "p" << std::endl;
-      std::cout << std::endl;
+      game.add_throw(pts);
+      if (game.is_eliminated(in_turn))
+      {
+          std::cout << std::endl << game.get_name(in_turn) << " missed "
+                    << MAX_MISSES << " times in a row and is out!" << std::endl;
+      }
+      if (game.is_over())
+      {
+          std::cout << "Game over! The winner is "
+                    << game.get_name(game.get_winner()) << "!" << std::endl;
+          break;
+      }
 
-      turn += 1;
+      print_scoreboard(game, win_table);
     }
 
-    return EXIT_SUCCESS;
+    return result;
 }
@@ -1,10 +1,23 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++11 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += main.cpp \
-    player.cpp
+    game.cpp \
+    game_batch.cpp \
+    game_log.cpp \
+    player.cpp \
+    simulation.cpp \
+    throw_model.cpp \
+    win_table.cpp
 
 HEADERS += \
-    player.hh
+    game.hh \
+    game_batch.hh \
+    game_log.hh \
+    player.hh \
+    rules.hh \
+    simulation.hh \
+    throw_model.hh \
+    win_table.hh
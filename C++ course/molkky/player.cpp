@@ -4,8 +4,9 @@
 */
 
 #include "player.hh"
+#include "rules.hh"
 
-Player::Player(string name):
+Player::Player(const string& name):
     name_(name)
 {
     pts_ = 0;
@@ -18,10 +19,7 @@ Player::Player(string name):
  */
 void Player::add_points(int pts)
 {
-    if(pts_ + pts > 50)
-        pts_ = 25;
-    else
-        pts_ += pts;
+    pts_ = points_after_throw(pts_, pts);
 }
 
 
@@ -29,7 +27,7 @@ void Player::add_points(int pts)
  * @brief get_name returns the player name
  * @return player name
  */
-string Player::get_name()
+const string& Player::get_name() const
 {
     return name_;
 }
@@ -38,7 +36,7 @@ string Player::get_name()
  * @brief get_points returns the current amount of points the player has scored
  * @return amount of points
  */
-int Player::get_points()
+int Player::get_points() const
 {
     return pts_;
 }
@@ -48,10 +46,7 @@ int Player::get_points()
  * @brief has_won checks if player has exactly 50 points
  * @return true = 50 points, false = other than 50 points
  */
-bool Player::has_won()
+bool Player::has_won() const
 {
-    if(pts_ == 50)
-        return true;
-    else
-        return false;
+    return is_winning(pts_);
 }
@@ -9,12 +9,12 @@ using namespace std;
 class Player
 {
 public:
-    Player(string name);
+    Player(const string& name);
 
     void add_points(int pts);
-    string get_name();
-    int get_points();
-    bool has_won();
+    const string& get_name() const;
+    int get_points() const;
+    bool has_won() const;
 
 private:
     string name_;
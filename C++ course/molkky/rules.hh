@@ -0,0 +1,64 @@
+/* Rules
+*
+* The scoring rules of mölkky, shared by Game_state, Player, Game_batch and
+* the simulation: points are added up, a player who goes over 50 points falls
+* back to 25, and a player who reaches exactly 50 points wins. Game_state,
+* which plays the games of Game and of the game log, also follows the rule
+* that a player who misses all the pins three times in a row is out of the
+* game.
+*/
+
+#ifndef RULES_HH
+#define RULES_HH
+
+const int WINNING_POINTS = 50;
+const int FALLBACK_POINTS = 25;
+
+// most points a single throw can score
+const int MAX_THROW_POINTS = 12;
+
+// misses in a row that put a player out of the game
+const int MAX_MISSES = 3;
+
+const int MIN_PLAYERS = 2;
+const int MAX_PLAYERS = 8;
+
+
+/**
+ * @brief points_after_throw gives a player's points after a throw. It has no
+ * branches, so that it vectorizes over arrays of small integers.
+ * @param pts points before the throw
+ * @param throw_pts points scored by the throw
+ * @return points after the throw
+ */
+template <typename Points>
+inline Points points_after_throw(Points pts, Points throw_pts)
+{
+    Points sum = pts + throw_pts;
+    return sum > WINNING_POINTS ? Points(FALLBACK_POINTS) : sum;
+}
+
+
+/**
+ * @brief is_winning checks if points win the game
+ * @param pts points of a player
+ * @return true = exactly 50 points
+ */
+template <typename Points>
+inline bool is_winning(Points pts)
+{
+    return pts == WINNING_POINTS;
+}
+
+
+/**
+ * @brief is_out checks if misses in a row put a player out of the game
+ * @param misses throws in a row that scored 0 points
+ * @return true = out of the game
+ */
+inline bool is_out(int misses)
+{
+    return misses >= MAX_MISSES;
+}
+
+#endif // RULES_HH
@@ -0,0 +1,31 @@
+#ifndef SIMULATION_HH
+#define SIMULATION_HH
+
+#include "throw_model.hh"
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+
+struct Simulation_options
+{
+    unsigned int threads = 1;
+    uint64_t seed = 1;
+    // games not won after this many turns are unfinished
+    int max_turns = 1000;
+};
+
+struct Simulation_result
+{
+    size_t games = 0;
+    size_t first_wins = 0;
+    size_t second_wins = 0;
+    size_t unfinished = 0;
+};
+
+
+Simulation_result simulate(const Throw_model& first, const Throw_model& second,
+                           size_t games, const Simulation_options& options);
+
+#endif // SIMULATION_HH
@@ -0,0 +1,173 @@
+/* Throw model
+*
+* Distributions of the points of a throw, which may depend on the points the
+* player already has, so that they can describe strategies such as aiming
+* for exactly the points needed near 50. A model is built from a
+* distribution for each of 0-50 points, so any model can be plugged in;
+* a few named ones are built from a target and an accuracy.
+*/
+
+#include "throw_model.hh"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+
+// A throw that does not hit the target misses all the pins with this
+// probability, and otherwise scores 1-12 points evenly.
+const double MISS_SHARE = 0.25;
+
+const double DEFAULT_ACCURACY = 0.5;
+
+/**
+ * @brief aimed_distribution gives the points of a throw aimed at a pin
+ * @param target points aimed at, 1-12
+ * @param accuracy probability of scoring the target
+ * @return the distribution
+ */
+Throw_distribution aimed_distribution(int target, double accuracy)
+{
+    Throw_distribution distribution;
+    distribution.fill((1 - accuracy) * (1 - MISS_SHARE) / MAX_THROW_POINTS);
+    distribution[0] = (1 - accuracy) * MISS_SHARE;
+    distribution[target] += accuracy;
+    return distribution;
+}
+
+}
+
+
+/**
+ * @brief Throw_model Constructor
+ * @param distributions distribution of the points of a throw for each of
+ * 0-50 points of the player; each should sum up to 1
+ */
+Throw_model::Throw_model(const vector<Throw_distribution>& distributions):
+    distributions_(distributions),
+    thresholds_(distributions.size())
+{
+    for(size_t pts = 0; pts < distributions.size(); ++pts)
+    {
+        double cumulative = 0;
+        for(int i = 0; i < MAX_THROW_POINTS; ++i)
+        {
+            cumulative += distributions[pts][i];
+            thresholds_[pts][i] = static_cast<uint64_t>(min(cumulative, 1.0) * 4294967296.0);
+        }
+    }
+}
+
+
+/**
+ * @brief uniform scores 0-12 points evenly, whatever the points
+ */
+Throw_model Throw_model::uniform()
+{
+    Throw_distribution distribution;
+    distribution.fill(1.0 / (MAX_THROW_POINTS + 1));
+    return Throw_model(vector<Throw_distribution>(WINNING_POINTS + 1, distribution));
+}
+
+
+/**
+ * @brief greedy aims for 12 points, or for exactly the points needed to win
+ * when that is less
+ * @param accuracy probability of scoring the points aimed for
+ */
+Throw_model Throw_model::greedy(double accuracy)
+{
+    vector<Throw_distribution> distributions;
+    for(int pts = 0; pts <= WINNING_POINTS; ++pts)
+    {
+        int needed = WINNING_POINTS - pts;
+        distributions.push_back(aimed_distribution(max(1, min(MAX_THROW_POINTS, needed)), accuracy));
+    }
+    return Throw_model(distributions);
+}
+
+
+/**
+ * @brief setup aims for exactly the points needed to win when they can be
+ * scored with one throw, and otherwise to leave half a throw's worth of
+ * points for the winning throw, so that a throw off its target rarely goes
+ * over 50
+ * @param accuracy probability of scoring the points aimed for
+ */
+Throw_model Throw_model::setup(double accuracy)
+{
+    vector<Throw_distribution> distributions;
+    for(int pts = 0; pts <= WINNING_POINTS; ++pts)
+    {
+        int needed = WINNING_POINTS - pts;
+        int target = needed <= MAX_THROW_POINTS ? needed : needed - MAX_THROW_POINTS / 2;
+        distributions.push_back(aimed_distribution(max(1, min(MAX_THROW_POINTS, target)), accuracy));
+    }
+    return Throw_model(distributions);
+}
+
+
+/**
+ * @brief parse builds a named model from a description such as "greedy:0.6"
+ * @param description uniform, greedy or setup, the latter two with an
+ * optional accuracy of 0-1 after a colon
+ * @param model set to the model
+ * @return true if the description was valid
+ */
+bool Throw_model::parse(const string& description, Throw_model& model)
+{
+    string::size_type colon = description.find(':');
+    string name = description.substr(0, colon);
+    double accuracy = DEFAULT_ACCURACY;
+    if(colon != string::npos)
+    {
+        const char* begin = description.c_str() + colon + 1;
+        char* end = nullptr;
+        accuracy = strtod(begin, &end);
+        if(end == begin or *end != '\0' or not (accuracy >= 0 and accuracy <= 1))
+        {
+            return false;
+        }
+    }
+
+    if(name == "uniform" and colon == string::npos)
+    {
+        model = uniform();
+    }
+    else if(name == "greedy")
+    {
+        model = greedy(accuracy);
+    }
+    else if(name == "setup")
+    {
+        model = setup(accuracy);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief get_probability returns the probability of scoring points with a throw
+ * @param pts points of the player before the throw, 0-50
+ * @param throw_pts points of the throw, 0-12
+ * @return probability
+ */
+double Throw_model::get_probability(int pts, int throw_pts) const
+{
+    return distributions_.at(pts).at(throw_pts);
+}
+
+
+/**
+ * @brief get_distribution returns the distribution of the points of a throw
+ * @param pts points of the player before the throw, 0-50
+ * @return distribution
+ */
+const Throw_distribution& Throw_model::get_distribution(int pts) const
+{
+    return distributions_.at(pts);
+}
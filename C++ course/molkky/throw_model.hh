@@ -0,0 +1,59 @@
+#ifndef THROW_MODEL_HH
+#define THROW_MODEL_HH
+
+#include "rules.hh"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// probability of scoring each of 0-12 points with a throw
+using Throw_distribution = array<double, MAX_THROW_POINTS + 1>;
+
+
+class Throw_model
+{
+public:
+    Throw_model(const vector<Throw_distribution>& distributions);
+
+    static Throw_model uniform();
+    static Throw_model greedy(double accuracy);
+    static Throw_model setup(double accuracy);
+    static bool parse(const string& description, Throw_model& model);
+
+    double get_probability(int pts, int throw_pts) const;
+    const Throw_distribution& get_distribution(int pts) const;
+
+    /**
+     * @brief throw_points draws the points of a throw
+     * @param pts points of the player before the throw, 0-50
+     * @param rng random number generator giving 64-bit numbers
+     * @return points scored, 0-12
+     */
+    template <typename Rng>
+    int throw_points(int pts, Rng& rng) const
+    {
+        // The points are the amount of thresholds at or below a random
+        // 32-bit number, counted without branches.
+        const uint64_t drawn = rng() >> 32;
+        const Thresholds& thresholds = thresholds_[pts];
+        int throw_pts = 0;
+        for(int i = 0; i < MAX_THROW_POINTS; ++i)
+        {
+            throw_pts += drawn >= thresholds[i];
+        }
+        return throw_pts;
+    }
+
+private:
+    // cumulative probabilities of scoring at most 0, 1, ..., 11 points, out
+    // of 2^32
+    using Thresholds = array<uint64_t, MAX_THROW_POINTS>;
+
+    vector<Throw_distribution> distributions_;
+    vector<Thresholds> thresholds_;
+};
+
+#endif // THROW_MODEL_HH
@@ -0,0 +1,161 @@
+/* Win table
+*
+* Exact win probabilities of every score of a two-player mölkky game, for
+* throw models of the players. A state is the points and the misses in a
+* row of the player in turn and of the other player and whose turn it is,
+* 2 * 51 * 51 * 3 * 3 states in all; a player with a third miss is out, and
+* the other player wins. The probability that the player in turn wins from
+* a state depends on the states after each throw, and as falling back to 25
+* points makes the states cyclic, the table is solved with value iteration
+* once when it is built. After that a query is a look-up.
+*/
+
+#include "win_table.hh"
+#include "rules.hh"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+const int SIDE = WINNING_POINTS + 1;
+const int STATES = 2 * SIDE * SIDE * MAX_MISSES * MAX_MISSES;
+
+// The iteration stops when no probability changes more than this during a
+// sweep, or after the most sweeps.
+const double TOLERANCE = 1e-15;
+const int MAX_SWEEPS = 100000;
+
+}
+
+
+/**
+ * @brief Win_table Constructor, solves the win probabilities
+ * @param first throw model of the first player
+ * @param second throw model of the second player
+ */
+Win_table::Win_table(const Throw_model& first, const Throw_model& second):
+    in_turn_wins_(STATES, 0.0),
+    other_wins_(STATES, 0.0),
+    sweeps_(0)
+{
+    const Throw_model* models[2] = {&first, &second};
+
+    // Gauss-Seidel sweeps: the updated probabilities are used in the same
+    // sweep, which converges faster than keeping those of the previous
+    // sweep. Throws mostly lead to more points, so the sweeps go from the
+    // most points down to use as many updated probabilities as they can.
+    // Starting from zero, the probabilities grow to those of winning
+    // at all, and games that never end are left to neither player.
+    double change = 1;
+    while(change > TOLERANCE and sweeps_ < MAX_SWEEPS)
+    {
+        change = 0;
+        for(int player = 0; player < 2; ++player)
+        {
+            for(int pts = WINNING_POINTS - 1; pts >= 0; --pts)
+            {
+                const Throw_distribution& distribution = models[player]->get_distribution(pts);
+                for(int other_pts = WINNING_POINTS - 1; other_pts >= 0; --other_pts)
+                {
+                    for(int misses = MAX_MISSES - 1; misses >= 0; --misses)
+                    {
+                        for(int other_misses = MAX_MISSES - 1; other_misses >= 0; --other_misses)
+                        {
+                            change = max(change, update(distribution, player, pts, other_pts,
+                                                        misses, other_misses));
+                        }
+                    }
+                }
+            }
+        }
+        ++sweeps_;
+    }
+}
+
+
+/**
+ * @brief get_win_probability returns the probability that a player wins
+ * @param player 0 for the first player, 1 for the second
+ * @param first_pts points of the first player, 0-50
+ * @param second_pts points of the second player, 0-50
+ * @param first_misses misses in a row of the first player, 0-3
+ * @param second_misses misses in a row of the second player, 0-3
+ * @param player_in_turn player who throws next, 0 or 1
+ * @return probability
+ */
+double Win_table::get_win_probability(int player, int first_pts, int second_pts, int first_misses,
+                                      int second_misses, int player_in_turn) const
+{
+    int pts[2] = {first_pts, second_pts};
+    int misses[2] = {first_misses, second_misses};
+    if(is_winning(pts[0]) or is_winning(pts[1]))
+    {
+        return is_winning(pts[player]) ? 1.0 : 0.0;
+    }
+    if(is_out(misses[0]) or is_out(misses[1]))
+    {
+        return is_out(misses[player]) ? 0.0 : 1.0;
+    }
+    size_t state = index(player_in_turn, pts[player_in_turn], pts[1 - player_in_turn],
+                         misses[player_in_turn], misses[1 - player_in_turn]);
+    return player == player_in_turn ? in_turn_wins_[state] : other_wins_[state];
+}
+
+
+/**
+ * @brief get_sweeps returns the amount of sweeps the value iteration took
+ * @return amount of sweeps
+ */
+int Win_table::get_sweeps() const
+{
+    return sweeps_;
+}
+
+
+size_t Win_table::index(int player_in_turn, int pts_in_turn, int other_pts, int misses_in_turn,
+                        int other_misses) const
+{
+    return (((player_in_turn * SIDE + pts_in_turn) * SIDE + other_pts) * MAX_MISSES + misses_in_turn)
+            * MAX_MISSES + other_misses;
+}
+
+
+/**
+ * @brief update computes the probabilities of a state from the current
+ * probabilities of the states after each throw
+ * @return the largest change of the probabilities
+ */
+double Win_table::update(const Throw_distribution& distribution, int player_in_turn, int pts_in_turn, int other_pts,
+                         int misses_in_turn, int other_misses)
+{
+    double in_turn_wins = 0;
+    double other_wins = 0;
+    for(int throw_pts = 0; throw_pts <= MAX_THROW_POINTS; ++throw_pts)
+    {
+        int after = points_after_throw(pts_in_turn, throw_pts);
+        double probability = distribution[throw_pts];
+        int misses_after = throw_pts == 0 ? misses_in_turn + 1 : 0;
+        if(is_winning(after))
+        {
+            in_turn_wins += probability;
+            continue;
+        }
+        if(is_out(misses_after))
+        {
+            other_wins += probability;
+            continue;
+        }
+        // The other player is in turn next, so the roles of the players
+        // swap in the state after the throw.
+        size_t next = index(1 - player_in_turn, other_pts, after, other_misses, misses_after);
+        in_turn_wins += probability * other_wins_[next];
+        other_wins += probability * in_turn_wins_[next];
+    }
+
+    size_t state = index(player_in_turn, pts_in_turn, other_pts, misses_in_turn, other_misses);
+    double change = max(fabs(in_turn_wins - in_turn_wins_[state]), fabs(other_wins - other_wins_[state]));
+    in_turn_wins_[state] = in_turn_wins;
+    other_wins_[state] = other_wins;
+    return change;
+}
@@ -0,0 +1,32 @@
+#ifndef WIN_TABLE_HH
+#define WIN_TABLE_HH
+
+#include "throw_model.hh"
+#include <vector>
+
+using namespace std;
+
+
+class Win_table
+{
+public:
+    Win_table(const Throw_model& first, const Throw_model& second);
+
+    double get_win_probability(int player, int first_pts, int second_pts, int first_misses,
+                               int second_misses, int player_in_turn) const;
+    int get_sweeps() const;
+
+private:
+    size_t index(int player_in_turn, int pts_in_turn, int other_pts, int misses_in_turn,
+                 int other_misses) const;
+    double update(const Throw_distribution& distribution, int player_in_turn, int pts_in_turn, int other_pts,
+                  int misses_in_turn, int other_misses);
+
+    // probabilities that the player in turn and that the other player win
+    // from each state
+    vector<double> in_turn_wins_;
+    vector<double> other_wins_;
+    int sweeps_;
+};
+
+#endif // WIN_TABLE_HH
@@ -0,0 +1,117 @@
+/* Game board
+ *
+ * Sets up the game board of pairs (memory) game and prints it.
+ */
+
+#include "game_board.hh"
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+void init_with_empties(Game_board_type& g_board, unsigned int rows, unsigned int columns)
+{
+    g_board.clear();
+    Game_row_type row;
+    for(unsigned int i = STARTING_ROW_COLUMN; i < columns; ++i)
+    {
+        Card card;
+        row.push_back(card);
+    }
+    for(unsigned int i = STARTING_ROW_COLUMN; i < rows; ++i)
+    {
+        g_board.push_back(row);
+    }
+}
+
+
+unsigned int next_free(Game_board_type& g_board, unsigned int lookup_start)
+{
+    unsigned int rows = g_board.size();
+    unsigned int columns = g_board.at(0).size();
+
+    for(unsigned int i = lookup_start; i < rows * columns; ++i)
+    {
+        if(g_board.at(i / columns).at(i % columns).get_visibility() == EMPTY)
+        {
+            return i;
+        }
+    }
+    
+    // If no free positions are found after desired starting position, the program 
+    // will look for them starting from the beginning of the board
+    for(unsigned int i = STARTING_ROW_COLUMN; i < lookup_start; ++i)
+    {
+        if(g_board.at(i / columns).at(i % columns).get_visibility() == EMPTY)
+        {
+            return i;
+        }
+    }
+    
+    // You should never reach this
+    std::cout << "No more empty spaces" << std::endl;
+    return rows * columns - 1;
+}
+
+
+void init_with_cards(Game_board_type& g_board, int seed)
+{
+    const unsigned int rows = g_board.size();
+    const unsigned int columns = g_board.at(0).size();
+
+    // Drawing a cell to be filled
+    std::default_random_engine randomEng(seed);
+    std::uniform_int_distribution<int> distr(0, rows * columns - 1);
+    distr(randomEng);
+
+    // If the drawn cell is already filled with a card, next empty cell will be used.
+    // (The next empty cell is searched for circularly, see function next_free.)
+    for(unsigned int i = 0, c = 'A'; i < rows * columns - 1; i += 2, ++c)
+    {
+        // Adding two identical cards (pairs) on the game board
+        for(unsigned int j = 0; j < 2; ++j)
+        {
+            unsigned int cell = distr(randomEng);
+            cell = next_free(g_board, cell);
+            g_board.at(cell / columns).at(cell % columns).set_letter(c);
+            g_board.at(cell / columns).at(cell % columns).set_visibility(HIDDEN);
+        }
+    }
+}
+
+
+void print_line_with_char(char c, unsigned int line_length)
+{
+    for(unsigned int i = 0; i < line_length * 2 + 7; ++i)
+    {
+        cout << c;
+    }
+    cout << endl;
+}
+
+
+void print(const Game_board_type& g_board)
+{
+    unsigned int rows = g_board.size();
+    unsigned int columns = g_board.at(0).size();
+
+    print_line_with_char('=', columns);
+    cout << "|   | ";
+    for(unsigned int i = STARTING_ROW_COLUMN; i < columns; ++i)
+    {
+        cout << i + 1 << " ";
+    }
+    cout << "|" << endl;
+    print_line_with_char('-', columns);
+    for(unsigned int i = STARTING_ROW_COLUMN; i < rows; ++i)
+    {
+        cout << "| " << i + 1 << " | ";
+        for(unsigned int j = STARTING_ROW_COLUMN; j < columns; ++j)
+        {
+            g_board.at(i).at(j).print();
+            cout << " ";
+        }
+        cout << "|" << endl;
+    }
+    print_line_with_char('=', columns);
+}
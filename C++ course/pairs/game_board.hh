@@ -0,0 +1,64 @@
+/* Game board
+ * ----------
+ * The game board of pairs (memory) game and the functions that set it up
+ * and print it.
+ * */
+
+#ifndef GAME_BOARD_HH
+#define GAME_BOARD_HH
+
+#include "card.hh"
+#include <vector>
+
+const unsigned int STARTING_ROW_COLUMN = 0;
+
+using Game_row_type = std::vector<Card>;
+using Game_board_type = std::vector<std::vector<Card>>;
+
+
+/**
+ * @brief init_with_empties Fills the game board with empty cards
+ * @param g_board game board
+ * @param rows number of rows on the game board
+ * @param columns number of columns on the game board
+ */
+void init_with_empties(Game_board_type& g_board, unsigned int rows, unsigned int columns);
+
+
+/**
+ * @brief next_free Finds the next free position in the game board (g_board), 
+ * starting from the given position start and continuing from the beginning if needed.
+ * (Called only by the function init_with_cards.)
+ * @param g_board game board
+ * @param lookup_start starting location for the free-position-search
+ * @return the next free empty card location
+ */
+unsigned int next_free(Game_board_type& g_board, unsigned int lookup_start);
+
+
+/**
+ * @brief init_with_cards Initializes the given game board (g_board) with randomly 
+ * generated cards, based on the given seed value.
+ * @param g_board game board
+ * @param seed randomEng seed
+ */
+void init_with_cards(Game_board_type& g_board, int seed);
+
+
+/**
+ * @brief print_line_with_charPrints a line consisting of the given character c.
+ * The length of the line is given in the parameter line_length.
+ * (Called only by the function print.)
+ * @param c
+ * @param line_length
+ */
+void print_line_with_char(char c, unsigned int line_length);
+
+
+/**
+ * @brief print Prints a variable-length game board with borders
+ * @param g_board game board
+ */
+void print(const Game_board_type& g_board);
+
+#endif // GAME_BOARD_HH
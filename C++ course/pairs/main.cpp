@@ -25,9 +25,10 @@
 
 #include "player.hh"
 #include "card.hh"
+#include "game_board.hh"
+#include <cstdlib>
 #include <iostream>
 #include <vector>
-#include <random>
 
 using namespace std;
 
@@ -41,11 +42,6 @@ const string NOT_FOUND = "Pairs not found.";
 const string GIVING_UP = "Why on earth you are giving up the game?";
 const string GAME_OVER = "Game over!";
 
-const unsigned int STARTING_ROW_COLUMN = 0;
-
-using Game_row_type = vector<Card>;
-using Game_board_type = vector<vector<Card>>;
-
 
 /**
  * @brief stoi_with_check Casts the given string into the corresponding
@@ -75,145 +71,6 @@ unsigned int stoi_with_check(const string& str)
 }
 
 
-/**
- * @brief init_with_empties Fills the game board with empty cards
- * @param g_board game board
- * @param rows number of rows on the game board
- * @param columns number of columns on the game board
- */
-void init_with_empties(Game_board_type& g_board, unsigned int rows, unsigned int columns)
-{
-    g_board.clear();
-    Game_row_type row;
-    for(unsigned int i = STARTING_ROW_COLUMN; i < columns; ++i)
-    {
-        Card card;
-        row.push_back(card);
-    }
-    for(unsigned int i = STARTING_ROW_COLUMN; i < rows; ++i)
-    {
-        g_board.push_back(row);
-    }
-}
-
-
-/**
- * @brief next_free Finds the next free position in the game board (g_board), 
- * starting from the given position start and continuing from the beginning if needed.
- * (Called only by the function init_with_cards.)
- * @param g_board game board
- * @param lookup_start starting location for the free-position-search
- * @return the next free empty card location
- */
-unsigned int next_free(Game_board_type& g_board, unsigned int lookup_start)
-{
-    unsigned int rows = g_board.size();
-    unsigned int columns = g_board.at(0).size();
-
-    for(unsigned int i = lookup_start; i < rows * columns; ++i)
-    {
-        if(g_board.at(i / columns).at(i % columns).get_visibility() == EMPTY)
-        {
-            return i;
-        }
-    }
-    
-    // If no free positions are found after desired starting position, the program 
-    // will look for them starting from the beginning of the board
-    for(unsigned int i = STARTING_ROW_COLUMN; i < lookup_start; ++i)
-    {
-        if(g_board.at(i / columns).at(i % columns).get_visibility() == EMPTY)
-        {
-            return i;
-        }
-    }
-    
-    // You should never reach this
-    std::cout << "No more empty spaces" << std::endl;
-    return rows * columns - 1;
-}
-
-
-/**
- * @brief init_with_cards Initializes the given game board (g_board) with randomly 
- * generated cards, based on the given seed value.
- * @param g_board game board
- * @param seed randomEng seed
- */
-void init_with_cards(Game_board_type& g_board, int seed)
-{
-    const unsigned int rows = g_board.size();
-    const unsigned int columns = g_board.at(0).size();
-
-    // Drawing a cell to be filled
-    std::default_random_engine randomEng(seed);
-    std::uniform_int_distribution<int> distr(0, rows * columns - 1);
-    distr(randomEng);
-
-    // If the drawn cell is already filled with a card, next empty cell will be used.
-    // (The next empty cell is searched for circularly, see function next_free.)
-    for(unsigned int i = 0, c = 'A'; i < rows * columns - 1; i += 2, ++c)
-    {
-        // Adding two identical cards (pairs) on the game board
-        for(unsigned int j = 0; j < 2; ++j)
-        {
-            unsigned int cell = distr(randomEng);
-            cell = next_free(g_board, cell);
-            g_board.at(cell / columns).at(cell % columns).set_letter(c);
-            g_board.at(cell / columns).at(cell % columns).set_visibility(HIDDEN);
-        }
-    }
-}
-
-
-/**
- * @brief print_line_with_charPrints a line consisting of the given character c.
- * The length of the line is given in the parameter line_length.
- * (Called only by the function print.)
- * @param c
- * @param line_length
- */
-void print_line_with_char(char c, unsigned int line_length)
-{
-    for(unsigned int i = 0; i < line_length * 2 + 7; ++i)
-    {
-        cout << c;
-    }
-    cout << endl;
-}
-
-
-/**
- * @brief print Prints a variable-length game board with borders
- * @param g_board game board
- */
-void print(const Game_board_type& g_board)
-{
-    unsigned int rows = g_board.size();
-    unsigned int columns = g_board.at(0).size();
-
-    print_line_with_char('=', columns);
-    cout << "|   | ";
-    for(unsigned int i = STARTING_ROW_COLUMN; i < columns; ++i)
-    {
-        cout << i + 1 << " ";
-    }
-    cout << "|" << endl;
-    print_line_with_char('-', columns);
-    for(unsigned int i = STARTING_ROW_COLUMN; i < rows; ++i)
-    {
-        cout << "| " << i + 1 << " | ";
-        for(unsigned int j = STARTING_ROW_COLUMN; j < columns; ++j)
-        {
-            g_board.at(i).at(j).print();
-            cout << " ";
-        }
-        cout << "|" << endl;
-    }
-    print_line_with_char('=', columns);
-}
-
-
 /**
  * @brief ask_product_and_calculate_factors Asks the desired product from the user,
  * and calculates the factors of the product such that the factor as near
@@ -290,7 +147,7 @@ vector<Player> create_players()
 void quit_game()
 {
     cout << GIVING_UP << endl;
-    return EXIT_SUCCESS;
+    exit(EXIT_SUCCESS);
 }
 
 
@@ -469,7 +326,7 @@ void game_over(vector<Player>& list_of_players)
              << list_of_players.at(winners.at(0)).get_number_of_pairs() 
              << " pairs." << endl;
     }
-    return EXIT_SUCCESS;
+    exit(EXIT_SUCCESS);
 }
 
 
@@ -5,9 +5,11 @@ CONFIG -= qt
 
 SOURCES += \
         card.cpp \
+        game_board.cpp \
         main.cpp \
         player.cpp
 
 HEADERS += \
     card.hh \
+    game_board.hh \
     player.hh
@@ -0,0 +1,17 @@
+TEMPLATE = app
+CONFIG += console c++11 thread testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../cards
+
+SOURCES += main.cpp \
+    ../../cards/cards.cpp \
+    ../../cards/concurrent_cards.cpp \
+    ../../cards/list_storage.cpp \
+    ../../cards/mapped_file.cpp \
+    ../../cards/ring_storage.cpp \
+    ../../cards/shuffle.cpp
+
+HEADERS += \
+    ../harness/test.hh
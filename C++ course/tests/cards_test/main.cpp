@@ -0,0 +1,623 @@
+/* Cards tests
+ *
+ * Tests of the deck of the cards program with both storage policies.
+ * Decks in a vector must be moved, not copied, when the vector grows.
+ * Printing a deck of 10^7 cards runs on a thread with a 64 KiB stack, so a
+ * print that recursed or kept the lines on the stack would crash the test.
+ */
+
+#include "cards.hh"
+#include "shuffle.hh"
+#include "test.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <pthread.h>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Stream buffer that keeps only the amount of lines written to it and the
+// first and last of them.
+class Line_counter : public streambuf
+{
+public:
+    size_t lines = 0;
+    string first_line;
+    string last_line;
+
+protected:
+    streamsize xsputn(const char* s, streamsize n) override
+    {
+        const char* end = s + n;
+        while(s != end)
+        {
+            const char* newline = static_cast<const char*>(memchr(s, '\n', end - s));
+            const char* line_end = newline == nullptr ? end : newline;
+            current_.append(s, line_end);
+            if(newline == nullptr)
+            {
+                break;
+            }
+            if(lines == 0)
+            {
+                first_line = current_;
+            }
+            ++lines;
+            last_line.swap(current_);
+            current_.clear();
+            s = newline + 1;
+        }
+        return n;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if(c != traits_type::eof())
+        {
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+        }
+        return c;
+    }
+
+private:
+    string current_;
+};
+
+const size_t PRINT_STACK_SIZE = 64 * 1024;
+const int PRINTED_CARDS = 10000000;
+
+// Prints a deck of PRINTED_CARDS cards both ways, on a thread with a small
+// stack.
+template <typename Deck>
+struct Print_job
+{
+    Deck deck;
+    Line_counter top_to_bottom;
+    Line_counter bottom_to_top;
+
+    static void* run(void* argument)
+    {
+        Print_job* job = static_cast<Print_job*>(argument);
+        ostream top_to_bottom(&job->top_to_bottom);
+        job->deck.print_from_top_to_bottom(top_to_bottom);
+        ostream bottom_to_top(&job->bottom_to_top);
+        job->deck.print_from_bottom_to_top(bottom_to_top);
+        return nullptr;
+    }
+};
+
+template <typename Deck>
+void test_print_large_deck()
+{
+    Print_job<Deck> job;
+    vector<int> ids(PRINTED_CARDS);
+    for(int i = 0; i < PRINTED_CARDS; ++i)
+    {
+        ids[i] = i;
+    }
+    job.deck.add_range(ids.data(), ids.data() + ids.size());
+
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, PRINT_STACK_SIZE);
+    pthread_t thread;
+    bool started = pthread_create(&thread, &attributes, &Print_job<Deck>::run, &job) == 0;
+    pthread_attr_destroy(&attributes);
+    if(not CHECK(started))
+    {
+        return;
+    }
+    pthread_join(thread, nullptr);
+
+    // The last id added is the topmost card.
+    CHECK(job.top_to_bottom.lines == PRINTED_CARDS);
+    CHECK(job.top_to_bottom.first_line == "1: 9999999");
+    CHECK(job.top_to_bottom.last_line == "10000000: 0");
+    CHECK(job.bottom_to_top.lines == PRINTED_CARDS);
+    CHECK(job.bottom_to_top.first_line == "1: 0");
+    CHECK(job.bottom_to_top.last_line == "10000000: 9999999");
+}
+
+// Grows a vector of decks and checks that the cards of the first deck stay
+// where they were, i.e. that the deck was moved rather than copied.
+template <typename Deck>
+void test_decks_in_vector()
+{
+    vector<Deck> decks(1);
+    for(int id = 0; id < 100; ++id)
+    {
+        decks.front().add(id);
+    }
+    const int* topmost = &*decks.front().begin();
+    for(int i = 0; i < 100; ++i)
+    {
+        decks.emplace_back();
+    }
+    CHECK(&*decks.front().begin() == topmost);
+    CHECK(decks.front().size() == 100);
+    CHECK(*decks.front().begin() == 99);
+}
+
+/**
+ * @brief chi_square_limit Approximates the critical value of the chi-square
+ * distribution at a 0.1 % significance level (Wilson-Hilferty)
+ * @param dof degrees of freedom
+ */
+double chi_square_limit(double dof)
+{
+    const double z = 3.090;
+    double a = 2.0 / (9.0 * dof);
+    return dof * pow(1.0 - a + z * sqrt(a), 3);
+}
+
+double chi_square(const vector<double>& observed, double expected)
+{
+    double sum = 0;
+    for(double count : observed)
+    {
+        sum += (count - expected) * (count - expected) / expected;
+    }
+    return sum;
+}
+
+// Shuffles a deck of 5 cards with Fisher-Yates with many seeds; each of the
+// 120 orders must come up about as often.
+void test_fisher_yates_permutations()
+{
+    const int n = 5;
+    const int orders = 120;
+    const int shuffles = 1000 * orders;
+    vector<double> observed(orders);
+    for(int seed = 0; seed < shuffles; ++seed)
+    {
+        int ids[n] = {0, 1, 2, 3, 4};
+        shuffle_ids(ids, n, seed);
+        // the index of the order (its Lehmer code)
+        int order = 0;
+        for(int i = 0; i < n; ++i)
+        {
+            int smaller_after = 0;
+            for(int j = i + 1; j < n; ++j)
+            {
+                smaller_after += ids[j] < ids[i];
+            }
+            order = order * (n - i) + smaller_after;
+        }
+        observed[order] += 1;
+    }
+    CHECK(chi_square(observed, shuffles / orders) < chi_square_limit(orders - 1));
+}
+
+// Shuffles a deck large enough for the parallel scatter shuffle, and counts
+// the cards of each 1/64 of the deck that end up in each 1/64. Cards must
+// not stay near their places nor move together.
+void test_parallel_shuffle_positions()
+{
+    const size_t n = PARALLEL_SHUFFLE_THRESHOLD;
+    const size_t parts = 64;
+    vector<int> ids(n);
+    for(uint64_t seed = 1; seed <= 2; ++seed)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            ids[i] = i;
+        }
+        shuffle_ids(ids.data(), n, seed);
+
+        vector<double> observed(parts * parts);
+        for(size_t position = 0; position < n; ++position)
+        {
+            observed[ids[position] / (n / parts) * parts + position / (n / parts)] += 1;
+        }
+        // The cards of each part fill whole parts, so the table has
+        // (parts - 1)^2 degrees of freedom.
+        double dof = (parts - 1) * (parts - 1);
+        CHECK(chi_square(observed, 1.0 * n / (parts * parts)) < chi_square_limit(dof));
+
+        vector<int> sorted(ids);
+        sort(sorted.begin(), sorted.end());
+        bool permutation = true;
+        for(size_t i = 0; i < n; ++i)
+        {
+            permutation = permutation and sorted[i] == static_cast<int>(i);
+        }
+        CHECK(permutation);
+    }
+}
+
+// The same seed gives the same order with both storage policies, on both
+// sides of the parallel threshold.
+void test_shuffle_is_deterministic()
+{
+    for(size_t n : {size_t(1000), PARALLEL_SHUFFLE_THRESHOLD})
+    {
+        vector<int> ids(n);
+        for(size_t i = 0; i < n; ++i)
+        {
+            ids[i] = i;
+        }
+        Cards list_deck;
+        Ring_cards ring_deck;
+        list_deck.add_range(ids.data(), ids.data() + n);
+        ring_deck.add_range(ids.data(), ids.data() + n);
+        list_deck.shuffle(7);
+        ring_deck.shuffle(7);
+        CHECK(equal(list_deck.begin(), list_deck.end(), ring_deck.begin()));
+
+        Cards again;
+        again.add_range(ids.data(), ids.data() + n);
+        again.shuffle(7);
+        CHECK(equal(list_deck.begin(), list_deck.end(), again.begin()));
+        again.shuffle(8);
+        CHECK(not equal(list_deck.begin(), list_deck.end(), again.begin()));
+    }
+}
+
+const char* const SNAPSHOT_PATH = "cards_test_snapshot.bin";
+
+template <typename Deck>
+vector<int> deck_ids(const Deck& deck)
+{
+    return vector<int>(deck.begin(), deck.end());
+}
+
+// A deck of the given size with the ids 0, 1, ... from the bottom up.
+template <typename Deck>
+Deck counted_deck(size_t size)
+{
+    Deck deck;
+    for(size_t id = 0; id < size; ++id)
+    {
+        deck.add(static_cast<int>(id));
+    }
+    return deck;
+}
+
+// Adds ranges of 0 to 100 cards to decks of 0 to 10 cards; each must give
+// the same deck as adding the cards one by one.
+template <typename Deck>
+void test_add_range()
+{
+    vector<int> ids(100);
+    for(size_t i = 0; i < ids.size(); ++i)
+    {
+        ids.at(i) = 1000 + static_cast<int>(i);
+    }
+    for(size_t size : {0, 1, 10})
+    {
+        for(size_t count : {0, 1, 15, 16, 17, 100})
+        {
+            Deck bulk = counted_deck<Deck>(size);
+            Deck single = counted_deck<Deck>(size);
+            bulk.add_range(ids.data(), ids.data() + count);
+            for(size_t i = 0; i < count; ++i)
+            {
+                single.add(ids.at(i));
+            }
+            CHECK(deck_ids(bulk) == deck_ids(single));
+        }
+    }
+}
+
+// Removes 0 cards, some cards, all the cards and more cards than there are;
+// each must remove the same cards as removing them one by one.
+template <typename Deck>
+void test_remove_n()
+{
+    for(size_t size : {0, 1, 10})
+    {
+        for(size_t n : {size_t(0), size_t(1), size, size + 1, size + 100})
+        {
+            Deck bulk = counted_deck<Deck>(size);
+            Deck single = counted_deck<Deck>(size);
+            vector<int> removed(n, -1);
+            size_t count = bulk.remove_n(n, removed.data());
+            vector<int> expected;
+            int id = 0;
+            while(expected.size() < n and single.remove(id))
+            {
+                expected.push_back(id);
+            }
+            CHECK(count == expected.size());
+            CHECK(vector<int>(removed.begin(), removed.begin() + count) == expected);
+            CHECK(deck_ids(bulk) == deck_ids(single));
+        }
+    }
+}
+
+// Rotates decks by negative amounts, by amounts past the size and by the
+// size itself; each must give the same deck as moving the cards one by one.
+template <typename Deck>
+void test_rotate()
+{
+    Deck empty;
+    CHECK(not empty.rotate(1));
+    for(ptrdiff_t size : {1, 2, 7, 100})
+    {
+        for(ptrdiff_t k : {-3 * size - 2, -size, -size + 1, ptrdiff_t(-1), ptrdiff_t(0), ptrdiff_t(1),
+                           size / 2, size - 1, size, size + 1, 2 * size + 3})
+        {
+            Deck bulk = counted_deck<Deck>(size);
+            Deck single = counted_deck<Deck>(size);
+            CHECK(bulk.rotate(k));
+            for(ptrdiff_t i = 0; i < (k % size + size) % size; ++i)
+            {
+                single.top_to_bottom();
+            }
+            CHECK(deck_ids(bulk) == deck_ids(single));
+        }
+    }
+}
+
+// A ring buffer filled to its capacity is rotated by moving its top index
+// only, so every card must stay at the same address.
+void test_rotate_full_ring()
+{
+    // Adding cards one by one doubles the capacity from 16, so 1024 cards
+    // fill the buffer.
+    const size_t size = 1024;
+    for(ptrdiff_t k : {ptrdiff_t(1), ptrdiff_t(-1), ptrdiff_t(300), ptrdiff_t(700), ptrdiff_t(-5000)})
+    {
+        Ring_cards bulk = counted_deck<Ring_cards>(size);
+        Cards single = counted_deck<Cards>(size);
+        vector<const int*> addresses(size);
+        for(const int& id : bulk)
+        {
+            addresses.at(id) = &id;
+        }
+        // The cards fill a buffer of exactly their number of slots.
+        auto range = minmax_element(addresses.begin(), addresses.end());
+        CHECK(*range.second - *range.first == ptrdiff_t(size) - 1);
+        CHECK(bulk.rotate(k));
+        CHECK(single.rotate(k));
+        CHECK(deck_ids(bulk) == deck_ids(single));
+        bool moved = false;
+        for(const int& id : bulk)
+        {
+            moved = moved or addresses.at(id) != &id;
+        }
+        CHECK(not moved);
+    }
+}
+
+// Splices decks with and without cards on either side, and a deck onto
+// itself. The cards of the other deck must end up on top in their order,
+// and the other deck must be left empty and usable.
+template <typename Deck>
+void test_splice()
+{
+    for(size_t size : {0, 1, 20})
+    {
+        for(size_t other_size : {0, 1, 30})
+        {
+            Deck deck = counted_deck<Deck>(size);
+            Deck other;
+            for(size_t id = 0; id < other_size; ++id)
+            {
+                other.add(1000 + static_cast<int>(id));
+            }
+            vector<int> expected = deck_ids(other);
+            vector<int> below = deck_ids(deck);
+            expected.insert(expected.end(), below.begin(), below.end());
+
+            deck.splice(other);
+            CHECK(deck_ids(deck) == expected);
+            CHECK(deck.size() == size + other_size);
+            CHECK(other.size() == 0);
+            CHECK(other.begin() == other.end());
+
+            // The other deck can be filled again, and the cards it got
+            // from the spliced deck stay valid when it is destroyed.
+            other.add(5);
+            CHECK(deck_ids(other) == vector<int>{5});
+            other = Deck();
+            deck.add(-1);
+            expected.insert(expected.begin(), -1);
+            CHECK(deck_ids(deck) == expected);
+        }
+    }
+
+    Deck deck = counted_deck<Deck>(10);
+    const vector<int> before = deck_ids(deck);
+    deck.splice(deck);
+    CHECK(deck_ids(deck) == before);
+}
+
+// Copies decks by construction and by assignment, onto empty and nonempty
+// decks; each copy must keep its cards when its source changes and the
+// other way around, and a deck assigned to itself must keep its cards.
+template <typename Deck>
+void test_copies()
+{
+    for(size_t size : {0, 1, 50})
+    {
+        Deck source = counted_deck<Deck>(size);
+        const vector<int> before = deck_ids(source);
+
+        Deck constructed(source);
+        Deck assigned = counted_deck<Deck>(7);
+        assigned = source;
+        CHECK(deck_ids(constructed) == before);
+        CHECK(deck_ids(assigned) == before);
+
+        int id = 0;
+        source.add(-1);
+        source.remove(id);
+        source.remove(id);
+        source.rotate(3);
+        CHECK(deck_ids(constructed) == before);
+        CHECK(deck_ids(assigned) == before);
+
+        const vector<int> changed = deck_ids(source);
+        constructed.add(-2);
+        assigned = Deck();
+        CHECK(deck_ids(source) == changed);
+
+        Deck& alias = source;
+        source = alias;
+        CHECK(deck_ids(source) == changed);
+    }
+}
+
+// Moves decks by construction and by assignment; the moved-to deck must
+// get the cards and the moved-from deck must be empty and usable.
+template <typename Deck>
+void test_moves()
+{
+    for(size_t size : {0, 1, 50})
+    {
+        Deck source = counted_deck<Deck>(size);
+        const vector<int> before = deck_ids(source);
+
+        Deck constructed(std::move(source));
+        CHECK(deck_ids(constructed) == before);
+        CHECK(source.size() == 0);
+        CHECK(source.begin() == source.end());
+        source.add(1);
+        source.add(2);
+        CHECK(deck_ids(source) == (vector<int>{2, 1}));
+
+        Deck assigned = counted_deck<Deck>(7);
+        assigned = std::move(constructed);
+        CHECK(deck_ids(assigned) == before);
+        CHECK(constructed.size() == 0);
+        CHECK(constructed.begin() == constructed.end());
+        int id = 0;
+        CHECK(not constructed.remove(id));
+        constructed.add(3);
+        CHECK(deck_ids(constructed) == vector<int>{3});
+        CHECK(deck_ids(assigned) == before);
+    }
+}
+
+// Saves decks of 0, 1 and many cards and loads them back into decks of both
+// storage policies, which must then hold the same cards in the same order.
+template <typename Deck>
+void test_snapshot_round_trip()
+{
+    for(size_t n : {size_t(0), size_t(1), size_t(1000000)})
+    {
+        Deck deck;
+        for(size_t i = 0; i < n; ++i)
+        {
+            deck.add(static_cast<int>(i * 7919 % 1000003) - 500000);
+        }
+        if(not CHECK(deck.save(SNAPSHOT_PATH)))
+        {
+            continue;
+        }
+
+        // The decks to load into already have cards, which loading replaces.
+        Cards list_deck;
+        Ring_cards ring_deck;
+        list_deck.add(42);
+        ring_deck.add(42);
+        CHECK(list_deck.load(SNAPSHOT_PATH));
+        CHECK(ring_deck.load(SNAPSHOT_PATH));
+        CHECK(list_deck.size() == n);
+        CHECK(deck_ids(list_deck) == deck_ids(deck));
+        CHECK(deck_ids(ring_deck) == deck_ids(deck));
+    }
+}
+
+void write_file(const string& bytes)
+{
+    ofstream file(SNAPSHOT_PATH, ios::binary | ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+string read_file()
+{
+    ifstream file(SNAPSHOT_PATH, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+// Damaged files are rejected and leave the deck as it was.
+template <typename Deck>
+void test_snapshot_rejects_damaged_files()
+{
+    Deck saved;
+    for(int id = 0; id < 100; ++id)
+    {
+        saved.add(id);
+    }
+    saved.save(SNAPSHOT_PATH);
+    const string snapshot = read_file();
+    CHECK(snapshot.size() == 16 + 100 * sizeof(int));
+
+    string bad_magic = snapshot;
+    bad_magic[0] = 'X';
+    string bad_version = snapshot;
+    bad_version[4] ^= 1;
+    string bad_count = snapshot;
+    bad_count[8] ^= 1;
+    const vector<string> damaged = {
+        "",
+        snapshot.substr(0, 10),
+        snapshot.substr(0, 16),
+        snapshot.substr(0, snapshot.size() - sizeof(int)),
+        snapshot.substr(0, snapshot.size() - 1),
+        snapshot + "x",
+        bad_magic,
+        bad_version,
+        bad_count,
+    };
+    for(const string& bytes : damaged)
+    {
+        write_file(bytes);
+        Deck deck;
+        deck.add(1);
+        deck.add(2);
+        CHECK(not deck.load(SNAPSHOT_PATH));
+        CHECK(deck_ids(deck) == vector<int>({2, 1}));
+    }
+
+    remove(SNAPSHOT_PATH);
+    Deck deck;
+    CHECK(not deck.load(SNAPSHOT_PATH));
+}
+
+}
+
+
+int main()
+{
+    test_snapshot_round_trip<Cards>();
+    test_snapshot_round_trip<Ring_cards>();
+    test_snapshot_rejects_damaged_files<Cards>();
+    test_snapshot_rejects_damaged_files<Ring_cards>();
+
+    test_fisher_yates_permutations();
+    test_parallel_shuffle_positions();
+    test_shuffle_is_deterministic();
+
+    test_add_range<Cards>();
+    test_add_range<Ring_cards>();
+    test_remove_n<Cards>();
+    test_remove_n<Ring_cards>();
+    test_rotate<Cards>();
+    test_rotate<Ring_cards>();
+    test_rotate_full_ring();
+    test_splice<Cards>();
+    test_splice<Ring_cards>();
+
+    test_decks_in_vector<Cards>();
+    test_decks_in_vector<Ring_cards>();
+    test_copies<Cards>();
+    test_copies<Ring_cards>();
+    test_moves<Cards>();
+    test_moves<Ring_cards>();
+
+    test_print_large_deck<Cards>();
+    test_print_large_deck<Ring_cards>();
+
+    return test_result();
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+CONFIG += console c++14 thread testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../encryption
+
+SOURCES += main.cpp \
+    ../../encryption/cipher.cpp \
+    ../../encryption/encryption.cpp \
+    ../../encryption/substitution.cpp
+
+HEADERS += \
+    ../harness/test.hh
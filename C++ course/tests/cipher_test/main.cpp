@@ -0,0 +1,226 @@
+/* Cipher tests
+ *
+ * Tests of the keys and of the Cipher of the encryption program. Batches of
+ * valid keys and of keys with each kind of error are checked with
+ * validate_keys against a plain reference, and random texts are encrypted
+ * and decrypted back with inverted keys and with Cipher, both dropping and
+ * passing through the characters other than a-z. Ciphers with sequences of
+ * keys are compared with encrypt_with_keys, also when a text is encrypted
+ * in pieces that start at the position of their first letter.
+ */
+
+#include "cipher.hh"
+#include "encryption.hh"
+#include "test.hh"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const string ALPHABET = "abcdefghijklmnopqrstuvwxyz";
+
+string random_key(mt19937& rng)
+{
+    string key = ALPHABET;
+    shuffle(key.begin(), key.end(), rng);
+    return key;
+}
+
+// A text of mostly letters a-z and every other byte value in between.
+string random_text(mt19937& rng, size_t length)
+{
+    string text(length, '\0');
+    for(char& c : text)
+    {
+        unsigned value = rng() % 512;
+        c = static_cast<char>(value < 256 ? 'a' + value % 26 : value - 256);
+    }
+    return text;
+}
+
+// The letters a-z of a text, which is what survives dropping the rest.
+string letters_of(const string& text)
+{
+    string letters;
+    for(char c : text)
+    {
+        if(c >= 'a' and c <= 'z')
+        {
+            letters += c;
+        }
+    }
+    return letters;
+}
+
+// Reference for a valid key: 26 letters a-z, each once.
+bool is_valid_key(const string& key)
+{
+    if(key.length() != ALPHABET.length())
+    {
+        return false;
+    }
+    string sorted = key;
+    sort(sorted.begin(), sorted.end());
+    return sorted == ALPHABET;
+}
+
+// A key with one of the errors a key can have, or a valid key.
+string damaged_key(mt19937& rng)
+{
+    string key = random_key(rng);
+    switch(rng() % 7)
+    {
+    case 0:
+        key.pop_back();
+        break;
+    case 1:
+        key += key.at(rng() % key.size());
+        break;
+    case 2:
+        key.at(rng() % key.size()) = static_cast<char>('A' + rng() % 26);
+        break;
+    case 3:
+        key.at(rng() % key.size()) = static_cast<char>(rng() % 256);
+        break;
+    case 4:
+        key.at(rng() % key.size()) = key.at(rng() % key.size());
+        break;
+    case 5:
+        key.clear();
+        break;
+    default:
+        break;
+    }
+    return key;
+}
+
+void test_validate_keys(mt19937& rng)
+{
+    for(size_t count : {0, 1, 2, 100, 1000})
+    {
+        vector<string> keys(count);
+        for(string& key : keys)
+        {
+            key = damaged_key(rng);
+        }
+        vector<bool> valid(3, true);
+        size_t valid_count = validate_keys(keys, valid);
+
+        size_t expected_count = 0;
+        bool same = valid.size() == keys.size();
+        for(size_t i = 0; same and i < keys.size(); ++i)
+        {
+            bool expected = is_valid_key(keys.at(i));
+            expected_count += expected;
+            same = valid.at(i) == expected and (key_error(keys.at(i)) == nullptr) == expected;
+        }
+        CHECK(same);
+        CHECK(valid_count == expected_count);
+    }
+}
+
+void test_invert_key(mt19937& rng)
+{
+    CHECK(invert_key(ALPHABET) == ALPHABET);
+    string reversed(ALPHABET.rbegin(), ALPHABET.rend());
+    CHECK(invert_key(reversed) == reversed);
+
+    for(int i = 0; i < 1000; ++i)
+    {
+        const string key = random_key(rng);
+        const string inverse = invert_key(key);
+        CHECK(is_valid_key(inverse));
+        CHECK(invert_key(inverse) == key);
+        CHECK(encrypt(key, inverse) == ALPHABET);
+
+        const string text = random_text(rng, rng() % 300);
+        CHECK(encrypt(encrypt(text, key), inverse) == letters_of(text));
+    }
+}
+
+void test_cipher_round_trips(mt19937& rng)
+{
+    for(int i = 0; i < 1000; ++i)
+    {
+        const string key = random_key(rng);
+        const string text = random_text(rng, rng() % 300);
+
+        Cipher dropping;
+        CHECK(dropping.set_key(key));
+        CHECK(dropping.encrypt(text) == encrypt(text, key));
+        CHECK(dropping.decrypt(dropping.encrypt(text)) == letters_of(text));
+        CHECK(dropping.decrypt(text) == encrypt(text, invert_key(key)));
+
+        Cipher passing;
+        CHECK(passing.set_key(key));
+        passing.set_passthrough(true);
+        CHECK(passing.decrypt(passing.encrypt(text)) == text);
+    }
+
+    Cipher cipher;
+    CHECK(cipher.encrypt("abc, def") == "");
+    CHECK(not cipher.set_key("abc"));
+    CHECK(cipher.key_count() == 0);
+}
+
+void test_key_sequences(mt19937& rng)
+{
+    for(int i = 0; i < 1000; ++i)
+    {
+        vector<string> keys(1 + rng() % 40);
+        for(string& key : keys)
+        {
+            key = random_key(rng);
+        }
+        const string text = random_text(rng, rng() % 600);
+        const string expected = encrypt_with_keys(text, keys);
+
+        Cipher dropping;
+        CHECK(dropping.set_keys(keys));
+        CHECK(dropping.key_count() == keys.size());
+        CHECK(dropping.encrypt(text) == expected);
+        CHECK(dropping.decrypt(expected) == letters_of(text));
+
+        // Each piece starts at the key of the letters before it.
+        string pieces(text.size(), '\0');
+        size_t written = 0;
+        size_t position = 0;
+        for(size_t begin = 0; begin < text.size(); )
+        {
+            size_t length = min<size_t>(text.size() - begin, rng() % 50);
+            written += dropping.encrypt(text.data() + begin, length, &pieces[written], position);
+            position += letters_of(text.substr(begin, length)).size();
+            begin += length;
+        }
+        CHECK(pieces.substr(0, written) == expected);
+
+        Cipher passing;
+        CHECK(passing.set_keys(keys));
+        passing.set_passthrough(true);
+        const string encrypted = passing.encrypt(text);
+        CHECK(letters_of(encrypted) == expected);
+        CHECK(passing.decrypt(encrypted) == text);
+    }
+
+    Cipher cipher;
+    CHECK(not cipher.set_keys({}));
+    CHECK(not cipher.set_keys({random_key(rng), "abc", random_key(rng)}));
+    CHECK(cipher.key_count() == 0);
+}
+
+}
+
+int main()
+{
+    mt19937 rng(1);
+    test_validate_keys(rng);
+    test_invert_key(rng);
+    test_cipher_round_trips(rng);
+    test_key_sequences(rng);
+
+    return test_result();
+}
@@ -0,0 +1,19 @@
+TEMPLATE = app
+CONFIG += console c++11 thread testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# The test is meant to be run under ThreadSanitizer, which reports any data
+# race of the deck even when the cards come out right.
+unix {
+    QMAKE_CXXFLAGS += -fsanitize=thread -g
+    QMAKE_LFLAGS += -fsanitize=thread
+}
+
+INCLUDEPATH += ../harness ../../cards
+
+SOURCES += main.cpp \
+    ../../cards/concurrent_cards.cpp
+
+HEADERS += \
+    ../harness/test.hh
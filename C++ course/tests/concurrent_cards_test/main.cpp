@@ -0,0 +1,98 @@
+/* Concurrent cards tests
+ *
+ * Stress test of Concurrent_cards: threads add cards with ids of their own
+ * and remove cards in a random mix, and in the end every card that was added
+ * must have been removed or be left in the deck exactly once. The test is
+ * built with ThreadSanitizer, so it also catches data races.
+ */
+
+#include "concurrent_cards.hh"
+#include "test.hh"
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const int MIN_THREADS = 4;
+const int ADDS_PER_THREAD = 100000;
+
+// Adds the ids first_id, first_id + 1, ... and removes a card after about
+// every other addition, keeping the removed ids.
+void add_and_remove(Concurrent_cards& deck, int first_id, unsigned int seed, vector<int>& removed)
+{
+    mt19937 rng(seed);
+    for(int i = 0; i < ADDS_PER_THREAD; ++i)
+    {
+        deck.add(first_id + i);
+        while(rng() % 2 == 0)
+        {
+            int id = 0;
+            if(not deck.remove(id))
+            {
+                break;
+            }
+            removed.push_back(id);
+        }
+    }
+}
+
+void test_no_card_lost_or_duplicated()
+{
+    const int threads = max(MIN_THREADS, static_cast<int>(thread::hardware_concurrency()));
+    Concurrent_cards deck;
+    vector<vector<int>> removed(threads);
+    vector<thread> workers;
+    for(int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back(add_and_remove, ref(deck), t * ADDS_PER_THREAD, t + 1, ref(removed[t]));
+    }
+    for(thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    const size_t cards = static_cast<size_t>(threads) * ADDS_PER_THREAD;
+    size_t removed_count = 0;
+    for(const vector<int>& ids : removed)
+    {
+        removed_count += ids.size();
+    }
+    CHECK(deck.size() == cards - removed_count);
+
+    vector<int> seen(cards, 0);
+    bool in_range = true;
+    auto count = [&](int id) {
+        if(id < 0 or static_cast<size_t>(id) >= cards)
+        {
+            in_range = false;
+            return;
+        }
+        ++seen[id];
+    };
+    for(const vector<int>& ids : removed)
+    {
+        for_each(ids.begin(), ids.end(), count);
+    }
+    int id = 0;
+    while(deck.remove(id))
+    {
+        count(id);
+    }
+    CHECK(in_range);
+    CHECK(deck.size() == 0);
+    CHECK(count_if(seen.begin(), seen.end(), [](int times) { return times != 1; }) == 0);
+}
+
+}
+
+
+int main()
+{
+    test_no_card_lost_or_duplicated();
+
+    return test_result();
+}
@@ -0,0 +1,65 @@
+#!/bin/sh
+# Compiles key.cpp with a valid key and with each kind of invalid key, and
+# checks that only the valid key compiles and that each invalid key fails
+# with the message of its static_assert.
+#
+# Usage: compile_fail.sh COMPILER ENCRYPTION_DIRECTORY
+
+compiler=${1:-c++}
+encryption=${2:-$(dirname "$0")/../../encryption}
+source=$(dirname "$0")/key.cpp
+output=$(mktemp)
+trap 'rm -f "$output"' EXIT
+
+checks=0
+failed=0
+
+# compile KEY: compiles key.cpp with KEY, leaving the messages in $output
+compile()
+{
+    "$compiler" -std=c++14 -fsyntax-only -I "$encryption" "-DFIXED_KEY=\"$1\"" "$source" \
+        > "$output" 2>&1
+}
+
+# expect_compiles KEY
+expect_compiles()
+{
+    checks=$((checks + 1))
+    if ! compile "$1"
+    then
+        echo "key $1 does not compile:"
+        cat "$output"
+        failed=$((failed + 1))
+    fi
+}
+
+# expect_error KEY MESSAGE
+expect_error()
+{
+    checks=$((checks + 1))
+    if compile "$1"
+    then
+        echo "key $1 compiles"
+        failed=$((failed + 1))
+    elif ! grep -q -F "$2" "$output"
+    then
+        echo "key $1 does not fail with \"$2\":"
+        cat "$output"
+        failed=$((failed + 1))
+    fi
+}
+
+expect_compiles "qwertyuiopasdfghjklzxcvbnm"
+expect_error "" "must contain 26 characters"
+expect_error "qwertyuiopasdfghjklzxcvbn" "must contain 26 characters"
+expect_error "qwertyuiopasdfghjklzxcvbnma" "must contain 26 characters"
+expect_error "Qwertyuiopasdfghjklzxcvbnm" "must contain lower case characters only"
+expect_error "qwertyuiop-sdfghjklzxcvbnm" "must contain lower case characters only"
+expect_error "qwertyuiopasdfghjklzxcvbnq" "must contain all alphabets a-z"
+
+if [ "$failed" -ne 0 ]
+then
+    echo "$failed of $checks checks failed"
+    exit 1
+fi
+echo "All $checks checks passed"
@@ -0,0 +1,14 @@
+# Fixed_cipher checks its key with static_asserts, so an invalid key must
+# not compile. Nothing is built here: "make check" compiles a valid key and
+# each kind of invalid key with the compiler of the project and checks that
+# only the valid one compiles, and that each invalid one fails with the
+# message of its static_assert.
+TEMPLATE = aux
+
+OTHER_FILES += \
+    compile_fail.sh \
+    key.cpp
+
+check.commands = sh $$shell_quote($$PWD/compile_fail.sh) $$shell_quote($$QMAKE_CXX) \
+    $$shell_quote($$PWD/../../encryption)
+QMAKE_EXTRA_TARGETS += check
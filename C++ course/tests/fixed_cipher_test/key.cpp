@@ -0,0 +1,17 @@
+/* Fixed cipher key
+ *
+ * Instantiates Fixed_cipher with the key given as the macro FIXED_KEY.
+ * compile_fail.sh compiles this with valid and invalid keys.
+ */
+
+#include "fixed_cipher.hh"
+
+constexpr char KEY[] = FIXED_KEY;
+
+static_assert(Fixed_cipher<KEY>::encrypt('a') == KEY[0],
+              "The first letter must be encrypted with the first letter of the key.");
+
+int main()
+{
+    return Fixed_cipher<KEY>::encrypt("abc") == string(KEY, 3) ? 0 : 1;
+}
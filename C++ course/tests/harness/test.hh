@@ -0,0 +1,63 @@
+/* Test harness
+ * ------------
+ * Minimal checks for the test programs of the course exercises. A failed
+ * CHECK prints its file, line and condition and the test goes on; at the end
+ * test_result() reports the checks and gives the exit status of the program,
+ * so that the tests can be run with "make check".
+ * */
+
+#ifndef TEST_HH
+#define TEST_HH
+
+#include <cstdlib>
+#include <iostream>
+
+#define CHECK(condition) check_condition((condition), #condition, __FILE__, __LINE__)
+
+/**
+ * @brief checks_run and checks_failed Return the counters of all the checks
+ * and of the failed ones
+ */
+inline long& checks_run()
+{
+    static long checks = 0;
+    return checks;
+}
+
+inline long& checks_failed()
+{
+    static long failed = 0;
+    return failed;
+}
+
+/**
+ * @brief check_condition Counts a check and prints it if it failed
+ * @return the condition
+ */
+inline bool check_condition(bool condition, const char* text, const char* file, int line)
+{
+    ++checks_run();
+    if(not condition)
+    {
+        ++checks_failed();
+        std::cerr << file << ":" << line << ": check failed: " << text << std::endl;
+    }
+    return condition;
+}
+
+/**
+ * @brief test_result Prints the amount of checks run and failed
+ * @return EXIT_SUCCESS if all the checks passed, otherwise EXIT_FAILURE
+ */
+inline int test_result()
+{
+    if(checks_failed() == 0)
+    {
+        std::cout << "All " << checks_run() << " checks passed" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    std::cout << checks_failed() << " of " << checks_run() << " checks failed" << std::endl;
+    return EXIT_FAILURE;
+}
+
+#endif // TEST_HH
@@ -0,0 +1,720 @@
+/* Mölkky tests
+ *
+ * Tests of the molkky program. The Monte Carlo simulation and the win table
+ * follow the same rules, so the share of games the simulation gives the
+ * first player must agree with the win probability of the table.
+ *
+ * The win table must give the won and lost games at its boundaries,
+ * satisfy the equation it is solved from in every state, and give the
+ * games of players who always miss or always score 12 points exactly.
+ *
+ * Game_batch plays random throws in batches around its block size and is
+ * compared with the scoring rules applied to one game at a time.
+ *
+ * Games of 2-8 players play random throws with many misses and are
+ * compared with a plain model of the rules, so that players are put out,
+ * skipped and left standing alone as well as winning with 50 points.
+ *
+ * Interleaved games with names of any length are written to a game log,
+ * which must load back with the same names and replay every game to each
+ * of its throws. Version 1 logs without names must still load, and a log
+ * with a torn record at its end must load without it and be cut back to
+ * its whole records, after which games can be appended to it again.
+ */
+
+#include "game.hh"
+#include "game_batch.hh"
+#include "game_log.hh"
+#include "rules.hh"
+#include "simulation.hh"
+#include "test.hh"
+#include "throw_model.hh"
+#include "win_table.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Simulates games between two throw models with a fixed seed and compares
+// the share of games won by the first player with the win table. The
+// allowed difference is 5 standard deviations of the share.
+void test_simulation_matches_win_table(const Throw_model& first, const Throw_model& second)
+{
+    const size_t games = 1000000;
+    Simulation_options options;
+    options.threads = thread::hardware_concurrency() == 0 ? 1 : thread::hardware_concurrency();
+    options.seed = 7;
+    const Simulation_result result = simulate(first, second, games, options);
+    const Win_table table(first, second);
+
+    const double expected = table.get_win_probability(0, 0, 0, 0, 0, 0);
+    const double share = static_cast<double>(result.first_wins) / games;
+    const double deviation = sqrt(expected * (1 - expected) / games);
+    CHECK(result.games == games);
+    CHECK(result.unfinished == 0);
+    CHECK(fabs(share - expected) < 5 * deviation);
+}
+
+// Checks the win table against the probabilities of the states after each
+// throw in every state, including those a throw from 50 points or from a
+// third miss, checks that one of the players wins from every state, and
+// checks the won and lost states given as queries.
+void test_win_table_equation(const Throw_model& first, const Throw_model& second)
+{
+    const Win_table table(first, second);
+    const Throw_model* models[2] = {&first, &second};
+    double largest_error = 0;
+    double largest_sum_error = 0;
+    for(int in_turn = 0; in_turn < 2; ++in_turn)
+    {
+        for(int pts = 0; pts < WINNING_POINTS; ++pts)
+        {
+            for(int other_pts = 0; other_pts < WINNING_POINTS; ++other_pts)
+            {
+                for(int misses = 0; misses < MAX_MISSES; ++misses)
+                {
+                    for(int other_misses = 0; other_misses < MAX_MISSES; ++other_misses)
+                    {
+                        // probability that the player in turn wins, by the
+                        // outcomes of the throw
+                        double expected = 0;
+                        for(int throw_pts = 0; throw_pts <= MAX_THROW_POINTS; ++throw_pts)
+                        {
+                            int after = points_after_throw(pts, throw_pts);
+                            int misses_after = throw_pts == 0 ? misses + 1 : 0;
+                            int all_pts[2];
+                            int all_misses[2];
+                            all_pts[in_turn] = after;
+                            all_pts[1 - in_turn] = other_pts;
+                            all_misses[in_turn] = misses_after;
+                            all_misses[1 - in_turn] = other_misses;
+                            expected += models[in_turn]->get_probability(pts, throw_pts)
+                                    * table.get_win_probability(in_turn, all_pts[0], all_pts[1], all_misses[0],
+                                                                all_misses[1], 1 - in_turn);
+                        }
+
+                        int all_pts[2];
+                        int all_misses[2];
+                        all_pts[in_turn] = pts;
+                        all_pts[1 - in_turn] = other_pts;
+                        all_misses[in_turn] = misses;
+                        all_misses[1 - in_turn] = other_misses;
+                        double wins = table.get_win_probability(in_turn, all_pts[0], all_pts[1],
+                                                                all_misses[0], all_misses[1], in_turn);
+                        double other_wins = table.get_win_probability(1 - in_turn, all_pts[0], all_pts[1],
+                                                                      all_misses[0], all_misses[1], in_turn);
+                        largest_error = max(largest_error, fabs(wins - expected));
+                        largest_sum_error = max(largest_sum_error, fabs(wins + other_wins - 1));
+                    }
+                }
+            }
+        }
+    }
+    CHECK(largest_error < 1e-9);
+    CHECK(largest_sum_error < 1e-9);
+
+    // won, lost and out states, whoever is in turn
+    for(int in_turn = 0; in_turn < 2; ++in_turn)
+    {
+        CHECK(table.get_win_probability(0, WINNING_POINTS, 49, 0, 2, in_turn) == 1.0);
+        CHECK(table.get_win_probability(1, WINNING_POINTS, 49, 0, 2, in_turn) == 0.0);
+        CHECK(table.get_win_probability(1, 10, WINNING_POINTS, 2, 0, in_turn) == 1.0);
+        CHECK(table.get_win_probability(0, 49, 0, MAX_MISSES, 0, in_turn) == 0.0);
+        CHECK(table.get_win_probability(1, 49, 0, MAX_MISSES, 0, in_turn) == 1.0);
+        CHECK(table.get_win_probability(0, 0, 49, 0, MAX_MISSES, in_turn) == 1.0);
+    }
+}
+
+// A model that scores the same points with every throw.
+Throw_model always(int throw_pts)
+{
+    Throw_distribution distribution = {};
+    distribution[throw_pts] = 1;
+    return Throw_model(vector<Throw_distribution>(WINNING_POINTS + 1, distribution));
+}
+
+// Games of players who always miss or always score 12, whose outcome is
+// known.
+void test_win_table_certain_games()
+{
+    const Win_table missing(always(0), always(0));
+    // The player in turn is the first to miss a third time.
+    CHECK(missing.get_win_probability(0, 0, 0, 0, 0, 0) == 0.0);
+    CHECK(missing.get_win_probability(1, 0, 0, 0, 0, 0) == 1.0);
+    CHECK(missing.get_win_probability(0, 40, 10, 0, 2, 1) == 1.0);
+    CHECK(missing.get_win_probability(0, 40, 10, 2, 1, 0) == 0.0);
+
+    // Scoring 12 from 38 wins, but from 0 the points go 12, 24, 36, 48 and
+    // then round 25, 37 and 49 without ever being 50, so the game never
+    // ends and neither player wins.
+    const Win_table scoring(always(MAX_THROW_POINTS), always(MAX_THROW_POINTS));
+    CHECK(scoring.get_win_probability(0, 38, 38, 0, 0, 0) == 1.0);
+    CHECK(scoring.get_win_probability(1, 38, 38, 0, 0, 1) == 1.0);
+    CHECK(scoring.get_win_probability(0, 0, 0, 0, 0, 0) == 0.0);
+    CHECK(scoring.get_win_probability(1, 0, 0, 0, 0, 0) == 0.0);
+
+    // The first player always misses and is out after three throws, before
+    // the second player can miss three times.
+    const Win_table one_sided(always(0), Throw_model::uniform());
+    CHECK(fabs(one_sided.get_win_probability(1, 0, 0, 0, 0, 0) - 1) < 1e-12);
+}
+
+// Plays random throws in batches of games of 2-8 players until every game
+// is over, and compares the points, winners and finished games after each
+// turn with games scored one at a time.
+void test_game_batch(mt19937& rng)
+{
+    for(size_t games : {0, 1, 63, 64, 65, 200})
+    {
+        for(int players = MIN_PLAYERS; players <= MAX_PLAYERS; ++players)
+        {
+            Game_batch batch(games, players);
+            vector<vector<int>> points(games, vector<int>(players, 0));
+            vector<int> winners(games, -1);
+            size_t finished = 0;
+            bool same = true;
+            // Throws of 0-12 points end nearly every game in 400 turns.
+            for(int turn = 0; turn < 400 and finished < games; ++turn)
+            {
+                const int player = turn % players;
+                same = same and batch.get_player_in_turn() == player;
+                vector<unsigned char> throws(games);
+                for(size_t game = 0; game < games; ++game)
+                {
+                    throws.at(game) = static_cast<unsigned char>(rng() % (MAX_THROW_POINTS + 1));
+                    if(winners.at(game) == -1)
+                    {
+                        int& pts = points.at(game).at(player);
+                        pts = points_after_throw(pts, int(throws.at(game)));
+                        if(is_winning(pts))
+                        {
+                            winners.at(game) = player;
+                            ++finished;
+                        }
+                    }
+                }
+                batch.apply_turn(throws);
+
+                same = same and batch.get_turn() == turn + 1
+                        and batch.get_finished_games() == finished;
+                for(size_t game = 0; game < games; ++game)
+                {
+                    same = same and batch.get_winner(game) == winners.at(game);
+                    for(int other = 0; other < players; ++other)
+                    {
+                        same = same and batch.get_points(game, other) == points.at(game).at(other);
+                    }
+                }
+            }
+            CHECK(same);
+            CHECK(finished == games);
+
+            batch.reset();
+            CHECK(batch.get_turn() == 0);
+            CHECK(batch.get_finished_games() == 0);
+            CHECK(games == 0 or (batch.get_points(0, 0) == 0 and batch.get_winner(0) == -1));
+        }
+    }
+
+    bool rejected = false;
+    try
+    {
+        Game_batch batch(10, MAX_PLAYERS + 1);
+    }
+    catch(const invalid_argument&)
+    {
+        rejected = true;
+    }
+    CHECK(rejected);
+
+    rejected = false;
+    try
+    {
+        Game_batch batch(10, MIN_PLAYERS);
+        batch.apply_turn(vector<unsigned char>(9));
+    }
+    catch(const invalid_argument&)
+    {
+        rejected = true;
+    }
+    CHECK(rejected);
+}
+
+// Plain model of a game: the players throw in turns, skipping those who
+// are out, until one has 50 points or is the only one left.
+struct Model_game
+{
+    vector<int> points;
+    vector<int> misses;
+    int in_turn = 0;
+    int winner = -1;
+
+    Model_game(int players):
+        points(players, 0),
+        misses(players, 0)
+    {
+    }
+
+    int remaining() const
+    {
+        return static_cast<int>(count_if(misses.begin(), misses.end(), [](int m) { return m < 3; }));
+    }
+
+    void add_throw(int pts)
+    {
+        points.at(in_turn) = points.at(in_turn) + pts > 50 ? 25 : points.at(in_turn) + pts;
+        misses.at(in_turn) = pts == 0 ? misses.at(in_turn) + 1 : 0;
+        if(points.at(in_turn) == 50)
+        {
+            winner = in_turn;
+            return;
+        }
+        do
+        {
+            in_turn = (in_turn + 1) % points.size();
+        }
+        while(misses.at(in_turn) == 3);
+        if(remaining() == 1)
+        {
+            winner = in_turn;
+        }
+    }
+};
+
+bool same_game(const Game& game, const Model_game& model)
+{
+    bool same = game.get_player_in_turn() == model.in_turn and game.get_winner() == model.winner
+            and game.is_over() == (model.winner != -1)
+            and game.get_remaining_players() == model.remaining();
+    for(int player = 0; player < game.get_players(); ++player)
+    {
+        same = same and game.get_points(player) == model.points.at(player)
+                and game.get_misses(player) == model.misses.at(player)
+                and game.is_eliminated(player) == (model.misses.at(player) == 3);
+    }
+    return same;
+}
+
+// Plays random games of 2-8 players, in which a throw misses with the given
+// probability, and compares each turn with the model.
+void test_random_games(mt19937& rng, double miss_probability)
+{
+    bernoulli_distribution miss(miss_probability);
+    for(int players = MIN_PLAYERS; players <= MAX_PLAYERS; ++players)
+    {
+        vector<string> names;
+        for(int player = 0; player < players; ++player)
+        {
+            names.push_back("Player " + to_string(player + 1));
+        }
+        Game game(names);
+        int won_by_points = 0;
+        int won_by_elimination = 0;
+        for(int round = 0; round < 300; ++round)
+        {
+            game.reset();
+            Model_game model(players);
+            bool same = same_game(game, model);
+            int throws = 0;
+            while(same and not game.is_over() and throws < 10000)
+            {
+                int pts = miss(rng) ? 0 : 1 + rng() % MAX_THROW_POINTS;
+                bool over = game.add_throw(pts);
+                model.add_throw(pts);
+                ++throws;
+                same = same and over == game.is_over() and game.get_turn() == throws + 1
+                        and same_game(game, model);
+            }
+            CHECK(same);
+            CHECK(game.is_over());
+            if(game.get_points(game.get_winner()) == WINNING_POINTS)
+            {
+                ++won_by_points;
+            }
+            else
+            {
+                ++won_by_elimination;
+                CHECK(game.get_remaining_players() == 1);
+            }
+
+            // A finished game ignores further throws.
+            const int winner = game.get_winner();
+            CHECK(game.add_throw(5));
+            CHECK(game.get_turn() == throws + 1 and game.get_winner() == winner);
+        }
+        CHECK(won_by_points > 0);
+        CHECK(miss_probability < 0.5 or won_by_elimination > 0);
+    }
+}
+
+// Puts the first players out one by one and checks that they are skipped
+// and that the last player standing wins, with 2-8 players.
+void test_last_player_standing()
+{
+    for(int players = MIN_PLAYERS; players <= MAX_PLAYERS; ++players)
+    {
+        Game game(vector<string>(players, "Player"));
+        // Each round the first player still in misses and the others score
+        // 1 point, until only the last player is left.
+        int out = 0;
+        bool skipped = true;
+        while(not game.is_over())
+        {
+            int first_in = out;
+            for(int player = first_in; player < players and not game.is_over(); ++player)
+            {
+                skipped = skipped and game.get_player_in_turn() == player;
+                game.add_throw(player == first_in ? 0 : 1);
+            }
+            if(game.is_eliminated(first_in))
+            {
+                ++out;
+                skipped = skipped and game.get_remaining_players() == players - out;
+            }
+        }
+        CHECK(skipped);
+        CHECK(out == players - 1);
+        CHECK(game.get_winner() == players - 1);
+        CHECK(game.get_remaining_players() == 1);
+        CHECK(game.get_points(players - 1) < WINNING_POINTS);
+    }
+
+    // Scoring in between misses starts the count over.
+    Game game({"A", "B"});
+    for(int pts : {0, 5, 0, 5, 3, 5, 0, 5, 0, 5})
+    {
+        game.add_throw(pts);
+    }
+    CHECK(not game.is_over());
+    CHECK(game.get_misses(0) == 2);
+    CHECK(not game.is_eliminated(0));
+    game.add_throw(0);
+    CHECK(game.is_eliminated(0));
+    CHECK(game.get_winner() == 1);
+
+    for(int players : {0, 1, MAX_PLAYERS + 1})
+    {
+        bool rejected = false;
+        try
+        {
+            Game invalid(vector<string>(players, "Player"));
+        }
+        catch(const invalid_argument&)
+        {
+            rejected = true;
+        }
+        CHECK(rejected);
+    }
+}
+
+const char* const LOG_PATH = "molkky_test_log.bin";
+
+void write_file(const string& bytes)
+{
+    ofstream file(LOG_PATH, ios::binary | ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+string read_file()
+{
+    ifstream file(LOG_PATH, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+// Loads the log, keeping the errors and warnings it prints out of the
+// output of the test.
+bool load_log(Game_log& log)
+{
+    FILE* in = fopen(LOG_PATH, "rb");
+    if(in == nullptr)
+    {
+        return false;
+    }
+    ostringstream errors;
+    streambuf* cerr_buffer = cerr.rdbuf(errors.rdbuf());
+    bool loaded = log.load(in);
+    cerr.rdbuf(cerr_buffer);
+    fclose(in);
+    return loaded;
+}
+
+bool same_state(const Game_state& state, const Game_state& expected)
+{
+    bool same = state.players == expected.players and state.throws == expected.throws
+            and state.in_turn == expected.in_turn and state.remaining == expected.remaining
+            and state.winner == expected.winner;
+    for(int player = 0; player < MAX_PLAYERS; ++player)
+    {
+        same = same and state.points[player] == expected.points[player]
+                and state.misses[player] == expected.misses[player];
+    }
+    return same;
+}
+
+// A game to be logged, with the states after each of its throws.
+struct Logged_game
+{
+    uint32_t number;
+    vector<string> names;
+    vector<int> throws;
+    vector<Game_state> states;
+};
+
+Logged_game random_game(mt19937& rng, uint32_t number)
+{
+    Logged_game game;
+    game.number = number;
+    const int players = MIN_PLAYERS + rng() % (MAX_PLAYERS - MIN_PLAYERS + 1);
+    for(int player = 0; player < players; ++player)
+    {
+        // names of 0 to 20 characters, odd and even lengths
+        string name;
+        for(size_t length = rng() % 21; name.size() < length; )
+        {
+            name += "Aino Bert Cecilia"[rng() % 17];
+        }
+        game.names.push_back(name);
+    }
+    Game_state state;
+    state.start(players);
+    game.states.push_back(state);
+    // Some games are left unfinished, like a game stopped in the middle.
+    const size_t most_throws = rng() % 4 == 0 ? rng() % 20 : 1000;
+    while(not state.is_over() and game.throws.size() < most_throws)
+    {
+        int pts = rng() % 3 == 0 ? 0 : rng() % (MAX_THROW_POINTS + 1);
+        state.add_throw(pts);
+        game.throws.push_back(pts);
+        game.states.push_back(state);
+    }
+    return game;
+}
+
+/**
+ * @brief write_games Appends games to the log, their records interleaved
+ * @return false if writing failed
+ */
+bool write_games(const vector<Logged_game>& games, mt19937& rng)
+{
+    FILE* out = fopen(LOG_PATH, "ab");
+    if(out == nullptr)
+    {
+        return false;
+    }
+    bool ok = true;
+    {
+        Game_log_writer writer(out);
+        vector<size_t> written(games.size(), 0);
+        for(const Logged_game& game : games)
+        {
+            ok = writer.start_game(game.number, game.names) and ok;
+        }
+        size_t left = 0;
+        for(const Logged_game& game : games)
+        {
+            left += game.throws.size();
+        }
+        for(; left > 0; --left)
+        {
+            size_t g = rng() % games.size();
+            while(written.at(g) == games.at(g).throws.size())
+            {
+                g = (g + 1) % games.size();
+            }
+            ok = writer.add_throw(games.at(g).number, games.at(g).throws.at(written.at(g)++)) and ok;
+        }
+        ok = writer.flush() and ok;
+    }
+    return fclose(out) == 0 and ok;
+}
+
+// Checks that a loaded log has the games, their names and their states
+// after each throw.
+bool has_games(const Game_log& log, const vector<Logged_game>& games)
+{
+    bool same = true;
+    for(const Logged_game& game : games)
+    {
+        vector<string> names;
+        Game_state state;
+        same = same and log.get_names(game.number, names);
+        for(size_t player = 0; same and player < names.size(); ++player)
+        {
+            const string& expected = game.names.at(player);
+            same = names.at(player)
+                    == (expected.empty() ? "Player " + to_string(player + 1) : expected);
+        }
+        same = same and names.size() == game.names.size() and log.replay(game.number, state)
+                and same_state(state, game.states.back());
+        for(size_t throws = 0; same and throws < game.states.size(); ++throws)
+        {
+            same = log.replay(game.number, throws, state) and same_state(state, game.states.at(throws));
+        }
+        same = same and log.replay(game.number, game.states.size() + 5, state)
+                and same_state(state, game.states.back());
+    }
+    return same;
+}
+
+size_t throw_count(const vector<Logged_game>& games)
+{
+    size_t throws = 0;
+    for(const Logged_game& game : games)
+    {
+        throws += game.throws.size();
+    }
+    return throws;
+}
+
+void test_game_log_round_trip(mt19937& rng)
+{
+    remove(LOG_PATH);
+    vector<Logged_game> games;
+    for(uint32_t number = 0; number < 30; ++number)
+    {
+        games.push_back(random_game(rng, number * 3));
+    }
+    CHECK(write_games(games, rng));
+
+    Game_log log;
+    CHECK(load_log(log));
+    CHECK(not log.has_partial_record());
+    CHECK(log.get_size() == read_file().size());
+    CHECK(log.get_games() == games.size());
+    CHECK(log.get_throws() == throw_count(games));
+    CHECK(log.get_next_game() == games.back().number + 1);
+    CHECK(has_games(log, games));
+    Game_state state;
+    CHECK(not log.replay(1, state));
+    vector<string> names;
+    CHECK(not log.get_names(1, names));
+
+    // Games appended to the log are loaded after the earlier ones.
+    vector<Logged_game> more = {random_game(rng, log.get_next_game()),
+                                random_game(rng, log.get_next_game() + 1)};
+    CHECK(write_games(more, rng));
+    CHECK(load_log(log));
+    CHECK(log.get_games() == games.size() + more.size());
+    CHECK(has_games(log, games));
+    CHECK(has_games(log, more));
+
+    // Invalid logs are rejected.
+    const string bytes = read_file();
+    string bad_magic = bytes;
+    bad_magic.at(0) = 'X';
+    string bad_version = bytes;
+    bad_version.at(8) = 3;
+    string started_again = bytes + bytes.substr(16, 8);
+    string throw_before_start = bytes + string("\x01\0\0\0\x01\x05\0\0", 8);
+    string bad_throw = bytes + bytes.substr(16, 4) + string("\x01\x0d\0\0", 4);
+    for(const string& invalid : {bad_magic, bad_version, started_again, throw_before_start, bad_throw})
+    {
+        write_file(invalid);
+        CHECK(not load_log(log));
+    }
+    remove(LOG_PATH);
+}
+
+// A version 1 log, without name records, written byte by byte.
+void test_version_1_log()
+{
+    string bytes = string("MOLKKLOG\x01\0\0\0\0\0\0\0", 16);
+    auto record = [&bytes](uint32_t game, char kind, char value)
+    {
+        bytes += string(1, static_cast<char>(game)) + string(3, '\0') + kind + value + string(2, '\0');
+    };
+    record(4, 0, 3);
+    record(7, 0, 2);
+    Game_state first;
+    first.start(3);
+    Game_state second;
+    second.start(2);
+    for(int pts : {12, 0, 7, 12, 0, 0, 12})
+    {
+        record(4, 1, static_cast<char>(pts));
+        first.add_throw(pts);
+        record(7, 1, static_cast<char>(12 - pts));
+        second.add_throw(12 - pts);
+    }
+    write_file(bytes);
+
+    Game_log log;
+    CHECK(load_log(log));
+    CHECK(log.get_games() == 2);
+    CHECK(log.get_throws() == 14);
+    CHECK(log.get_next_game() == 8);
+    vector<string> names;
+    CHECK(log.get_names(4, names));
+    CHECK(names == (vector<string>{"Player 1", "Player 2", "Player 3"}));
+    Game_state state;
+    CHECK(log.replay(4, state) and same_state(state, first));
+    CHECK(log.replay(7, state) and same_state(state, second));
+    remove(LOG_PATH);
+}
+
+// Tears the last record of a log at every byte, as if the program had been
+// stopped while writing it.
+void test_torn_record(mt19937& rng)
+{
+    vector<Logged_game> games = {random_game(rng, 0), random_game(rng, 1)};
+    for(size_t torn = 1; torn < 8; ++torn)
+    {
+        remove(LOG_PATH);
+        CHECK(write_games(games, rng));
+        const string whole = read_file();
+        write_file(whole + string("\x01\0\0\0\x01\x05\0", torn));
+
+        Game_log log;
+        CHECK(load_log(log));
+        CHECK(log.has_partial_record());
+        CHECK(log.get_size() == whole.size());
+        CHECK(log.get_throws() == throw_count(games));
+        CHECK(has_games(log, games));
+
+        // Cut back to the whole records, the log takes new games.
+        CHECK(truncate_log(LOG_PATH, log.get_size()));
+        CHECK(read_file() == whole);
+        vector<Logged_game> more = {random_game(rng, log.get_next_game())};
+        CHECK(write_games(more, rng));
+        CHECK(load_log(log));
+        CHECK(not log.has_partial_record());
+        CHECK(has_games(log, games));
+        CHECK(has_games(log, more));
+    }
+    remove(LOG_PATH);
+}
+
+}
+
+int main()
+{
+    mt19937 rng(1);
+    test_game_batch(rng);
+    test_win_table_equation(Throw_model::greedy(0.5), Throw_model::setup(0.3));
+    test_win_table_equation(Throw_model::uniform(), Throw_model::greedy(0.9));
+    test_win_table_certain_games();
+    test_random_games(rng, 0.2);
+    test_random_games(rng, 0.6);
+    test_last_player_standing();
+    test_game_log_round_trip(rng);
+    test_version_1_log();
+    test_torn_record(rng);
+
+    test_simulation_matches_win_table(Throw_model::greedy(0.5), Throw_model::greedy(0.5));
+    test_simulation_matches_win_table(Throw_model::greedy(0.3), Throw_model::setup(0.3));
+    test_simulation_matches_win_table(Throw_model::uniform(), Throw_model::setup(0.7));
+
+    return test_result();
+}
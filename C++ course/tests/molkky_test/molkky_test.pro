@@ -0,0 +1,17 @@
+TEMPLATE = app
+CONFIG += console c++11 thread testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../molkky
+
+SOURCES += main.cpp \
+    ../../molkky/game.cpp \
+    ../../molkky/game_batch.cpp \
+    ../../molkky/game_log.cpp \
+    ../../molkky/simulation.cpp \
+    ../../molkky/throw_model.cpp \
+    ../../molkky/win_table.cpp
+
+HEADERS += \
+    ../harness/test.hh
@@ -0,0 +1,375 @@
+/* Stream tests
+ *
+ * Tests of the stream encryption of the encryption program. Random texts
+ * are encrypted through temporary files on one thread and in the pipeline
+ * of several threads, with chunks from a single character to larger than
+ * the text, and each output must equal the text encrypted at once by the
+ * cipher, also with sequences of keys, whose keys continue across chunks.
+ *
+ * CRC32C is compared with a bitwise reference for lengths around the parts
+ * the hardware checksum interleaves and combines. Framed outputs must pass
+ * the verifier on any amount of threads and hold the encrypted text, and
+ * truncated, reordered, corrupted and extended copies of them must fail it.
+ */
+
+#include "cipher.hh"
+#include "encryption.hh"
+#include "stream.hh"
+#include "test.hh"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+string random_key(mt19937& rng)
+{
+    string key = "abcdefghijklmnopqrstuvwxyz";
+    shuffle(key.begin(), key.end(), rng);
+    return key;
+}
+
+// A text of mostly letters a-z and every other byte value in between.
+string random_text(mt19937& rng, size_t length)
+{
+    string text(length, '\0');
+    for(char& c : text)
+    {
+        unsigned value = rng() % 512;
+        c = static_cast<char>(value < 256 ? 'a' + value % 26 : value - 256);
+    }
+    return text;
+}
+
+// A temporary file holding the given bytes, rewound to its start.
+FILE* file_with(const string& bytes)
+{
+    FILE* file = tmpfile();
+    if(file != nullptr)
+    {
+        fwrite(bytes.data(), 1, bytes.size(), file);
+        rewind(file);
+    }
+    return file;
+}
+
+string contents_of(FILE* file)
+{
+    string bytes;
+    rewind(file);
+    char buffer[4096];
+    size_t read = 0;
+    while((read = fread(buffer, 1, sizeof(buffer), file)) != 0)
+    {
+        bytes.append(buffer, read);
+    }
+    return bytes;
+}
+
+/**
+ * @brief stream_encrypt Encrypts a text with encrypt_stream through
+ * temporary files
+ * @return the encrypted text, or a string with an error mark if
+ * encrypt_stream failed
+ */
+string stream_encrypt(const Cipher& cipher, const string& text, size_t chunk_size,
+                      unsigned int threads)
+{
+    FILE* in = file_with(text);
+    FILE* out = tmpfile();
+    string result = "encrypt_stream failed";
+    if(in != nullptr and out != nullptr and encrypt_stream(cipher, in, out, chunk_size, threads))
+    {
+        result = contents_of(out);
+    }
+    if(in != nullptr)
+    {
+        fclose(in);
+    }
+    if(out != nullptr)
+    {
+        fclose(out);
+    }
+    return result;
+}
+
+// Reference CRC32C, a bit at a time.
+uint32_t bitwise_crc32c(const string& bytes)
+{
+    uint32_t crc = 0xffffffffu;
+    for(char c : bytes)
+    {
+        crc ^= static_cast<unsigned char>(c);
+        for(int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+uint32_t get_u32(const string& bytes, size_t offset)
+{
+    uint32_t value = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(bytes.at(offset + i))) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief stream_encrypt_framed Encrypts a text with encrypt_framed_stream
+ * through temporary files
+ * @return the framed text, or an empty string if encrypting failed
+ */
+string stream_encrypt_framed(const Cipher& cipher, const string& text, size_t frame_size,
+                             unsigned int threads)
+{
+    FILE* in = file_with(text);
+    FILE* out = tmpfile();
+    string result;
+    if(in != nullptr and out != nullptr
+            and encrypt_framed_stream(cipher, in, out, frame_size, threads))
+    {
+        result = contents_of(out);
+    }
+    if(in != nullptr)
+    {
+        fclose(in);
+    }
+    if(out != nullptr)
+    {
+        fclose(out);
+    }
+    return result;
+}
+
+// Runs verify_frames on a framed text, keeping the error it prints out of
+// the output of the test.
+bool verify(const string& framed, unsigned int threads)
+{
+    FILE* in = file_with(framed);
+    if(in == nullptr)
+    {
+        return false;
+    }
+    ostringstream errors;
+    streambuf* cerr_buffer = cerr.rdbuf(errors.rdbuf());
+    bool intact = verify_frames(in, threads);
+    cerr.rdbuf(cerr_buffer);
+    fclose(in);
+    return intact;
+}
+
+// Offsets of the frames of a framed text, the end frame last.
+vector<size_t> frame_offsets(const string& framed)
+{
+    vector<size_t> offsets;
+    size_t offset = STREAM_HEADER_SIZE;
+    while(offset + FRAME_HEADER_SIZE <= framed.size())
+    {
+        offsets.push_back(offset);
+        uint32_t length = get_u32(framed, offset);
+        if(length == END_FRAME)
+        {
+            break;
+        }
+        offset += FRAME_HEADER_SIZE + length;
+    }
+    return offsets;
+}
+
+// The payloads of the frames of a framed text one after another.
+string payloads(const string& framed)
+{
+    string text;
+    for(size_t offset : frame_offsets(framed))
+    {
+        uint32_t length = get_u32(framed, offset);
+        if(length != END_FRAME)
+        {
+            text += framed.substr(offset + FRAME_HEADER_SIZE, length);
+        }
+    }
+    return text;
+}
+
+void test_crc32c(mt19937& rng)
+{
+    CHECK(crc32c(0, "123456789", 9) == 0xe3069283u);
+    CHECK(crc32c(0, "", 0) == 0);
+
+    // Lengths around one and two rounds of the three interleaved parts of
+    // 256 and 8192 bytes, and random ones.
+    vector<size_t> lengths;
+    for(size_t length = 0; length <= 64; ++length)
+    {
+        lengths.push_back(length);
+    }
+    for(size_t rounds : {3 * 256, 6 * 256, 3 * 8192, 6 * 8192, 3 * 8192 + 3 * 256})
+    {
+        for(size_t length = rounds - 9; length <= rounds + 9; ++length)
+        {
+            lengths.push_back(length);
+        }
+    }
+    for(int i = 0; i < 50; ++i)
+    {
+        lengths.push_back(rng() % 200000);
+    }
+
+    for(size_t length : lengths)
+    {
+        // The data starts at a random offset, so that the words are read
+        // unaligned, and the checksum is also continued from a random split.
+        const size_t offset = rng() % 8;
+        const string bytes = random_text(rng, offset + length);
+        const string data = bytes.substr(offset);
+        const uint32_t expected = bitwise_crc32c(data);
+        CHECK(crc32c(0, bytes.data() + offset, length) == expected);
+        const size_t split = length == 0 ? 0 : rng() % (length + 1);
+        CHECK(crc32c(crc32c(0, data.data(), split), data.data() + split, length - split) == expected);
+    }
+}
+
+void test_frames(mt19937& rng)
+{
+    Cipher cipher;
+    CHECK(cipher.set_keys({random_key(rng), random_key(rng)}));
+    for(size_t frame_size : {size_t(1), size_t(10), size_t(4096), FRAME_SIZE})
+    {
+        for(size_t length : {0, 1, 5000, 300000})
+        {
+            if(frame_size == 1 and length > 5000)
+            {
+                continue;
+            }
+            const string text = random_text(rng, length);
+            const string framed = stream_encrypt_framed(cipher, text, frame_size, 3);
+            CHECK(framed == stream_encrypt_framed(cipher, text, frame_size, 1));
+            CHECK(payloads(framed) == cipher.encrypt(text));
+            const vector<size_t> offsets = frame_offsets(framed);
+            CHECK(offsets.size() == (length + frame_size - 1) / frame_size + 1);
+            for(unsigned int threads : {1, 2, 4})
+            {
+                CHECK(verify(framed, threads));
+            }
+        }
+    }
+}
+
+// Damages a framed text of many frames, larger than a batch of the
+// verifier, in each way the verifier must detect.
+void test_damaged_frames(mt19937& rng)
+{
+    Cipher cipher;
+    CHECK(cipher.set_key(random_key(rng)));
+    cipher.set_passthrough(true);
+    const string framed = stream_encrypt_framed(cipher, random_text(rng, 20 << 20), 65536, 4);
+    const vector<size_t> offsets = frame_offsets(framed);
+    CHECK(verify(framed, 4));
+
+    const size_t last = offsets.size() - 2;
+    for(unsigned int threads : {1, 4})
+    {
+        // truncated: in the stream header, in a header, in a payload, in
+        // the last frame and without the end frame
+        for(size_t size : {size_t(5), offsets.at(1) + 3, offsets.at(1) + 100, offsets.at(last) + 20,
+                           offsets.back(), framed.size() - 1})
+        {
+            CHECK(not verify(framed.substr(0, size), threads));
+        }
+
+        // reordered: two frames of the same length swapped, early and past
+        // the first batch
+        for(size_t first : {size_t(0), last - 2})
+        {
+            const size_t second = first + 1;
+            const size_t frame_length = offsets.at(second) - offsets.at(first);
+            string reordered = framed;
+            reordered.replace(offsets.at(first), frame_length, framed, offsets.at(second), frame_length);
+            reordered.replace(offsets.at(second), frame_length, framed, offsets.at(first), frame_length);
+            CHECK(not verify(reordered, threads));
+        }
+
+        // a frame dropped
+        string dropped = framed;
+        dropped.erase(offsets.at(3), offsets.at(4) - offsets.at(3));
+        CHECK(not verify(dropped, threads));
+
+        // corrupted: a bit flipped in a payload, a checksum, a length, a
+        // sequence number, the end frame, the magic and the version
+        for(size_t position : {offsets.at(2) + FRAME_HEADER_SIZE + 7, offsets.at(last - 1) + 8,
+                               offsets.at(last) + FRAME_HEADER_SIZE + 500, offsets.at(5) + 1,
+                               offsets.at(6) + 4, offsets.back() + 9, size_t(3), size_t(8)})
+        {
+            string corrupted = framed;
+            corrupted.at(position) ^= 1 << (rng() % 8);
+            CHECK(not verify(corrupted, threads));
+        }
+
+        // text after the end frame
+        CHECK(not verify(framed + "x", threads));
+    }
+}
+
+void test_streams(mt19937& rng)
+{
+    const vector<size_t> lengths = {0, 1, 1000, 100000};
+    const vector<size_t> chunk_sizes = {1, 7, 4096, 65536, STREAM_CHUNK_SIZE};
+    const vector<unsigned int> thread_counts = {1, 2, 3, 8};
+
+    for(size_t key_count : {1, 3, 100})
+    {
+        vector<string> keys(key_count);
+        for(string& key : keys)
+        {
+            key = random_key(rng);
+        }
+        for(bool passthrough : {false, true})
+        {
+            Cipher cipher;
+            CHECK(cipher.set_keys(keys));
+            cipher.set_passthrough(passthrough);
+            for(size_t length : lengths)
+            {
+                const string text = random_text(rng, length);
+                const string expected = cipher.encrypt(text);
+                for(size_t chunk_size : chunk_sizes)
+                {
+                    // A chunk per character is slow in the pipeline, so
+                    // it is only used for the shorter texts.
+                    if(chunk_size < 16 and length > 1000)
+                    {
+                        continue;
+                    }
+                    for(unsigned int threads : thread_counts)
+                    {
+                        CHECK(stream_encrypt(cipher, text, chunk_size, threads) == expected);
+                    }
+                }
+            }
+        }
+    }
+}
+
+}
+
+int main()
+{
+    mt19937 rng(1);
+    test_streams(rng);
+    test_crc32c(rng);
+    test_frames(rng);
+    test_damaged_frames(rng);
+
+    return test_result();
+}
@@ -0,0 +1,230 @@
+/* Substitution tests
+ *
+ * Tests of the substitution kernels of the encryption program. Each kernel
+ * the running CPU supports substitutes random texts with random keys, both
+ * dropping and passing through the characters other than a-z, and its
+ * output is compared with the function encrypt or with a plain loop. The
+ * texts hold every byte value, start at random offsets of a vector and have
+ * every tail length from 0 to 64 after the full vector blocks, and they are
+ * substituted both into another buffer and in place. Kernels the CPU does
+ * not support are skipped and named in the output.
+ */
+
+#include "encryption.hh"
+#include "substitution.hh"
+#include "test.hh"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const Substitution_kernel KERNELS[] = {SCALAR_KERNEL, SSSE3_KERNEL, AVX2_KERNEL, AVX512_KERNEL};
+
+// Bytes written after the end of each output, which no kernel may touch.
+const size_t GUARD_BYTES = 64;
+const char GUARD = '#';
+
+/**
+ * @brief kernel_supported Checks if the running CPU has the instructions a
+ * kernel is compiled for
+ */
+bool kernel_supported(Substitution_kernel kernel)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    switch(kernel)
+    {
+    case SSSE3_KERNEL:
+        return __builtin_cpu_supports("ssse3");
+    case AVX2_KERNEL:
+        return __builtin_cpu_supports("avx2");
+    case AVX512_KERNEL:
+        return __builtin_cpu_supports("avx512bw") and __builtin_cpu_supports("avx512vbmi")
+                and __builtin_cpu_supports("avx512vbmi2");
+    default:
+        return true;
+    }
+#else
+    return kernel == SCALAR_KERNEL;
+#endif
+}
+
+string random_key(mt19937& rng)
+{
+    string key = "abcdefghijklmnopqrstuvwxyz";
+    shuffle(key.begin(), key.end(), rng);
+    return key;
+}
+
+// A text of mostly letters a-z and every other byte value in between, so
+// that both the letter blocks and the characters around them are covered.
+string random_text(mt19937& rng, size_t length)
+{
+    string text(length, '\0');
+    for(char& c : text)
+    {
+        unsigned value = rng() % 512;
+        c = static_cast<char>(value < 256 ? 'a' + value % 26 : value - 256);
+    }
+    return text;
+}
+
+// Lengths with every tail from 0 to 64 after 0 to 4 full 64-byte blocks,
+// and a few longer random ones.
+vector<size_t> test_lengths(mt19937& rng)
+{
+    vector<size_t> lengths;
+    for(size_t blocks = 0; blocks <= 4; ++blocks)
+    {
+        for(size_t tail = 0; tail <= 64; ++tail)
+        {
+            lengths.push_back(blocks * 64 + tail);
+        }
+    }
+    for(int i = 0; i < 20; ++i)
+    {
+        lengths.push_back(256 + rng() % 5000);
+    }
+    return lengths;
+}
+
+// Reference for passing through: letters substituted, the rest unchanged.
+string pass_through(const string& text, const vector<string>& keys, size_t position)
+{
+    string result = text;
+    for(char& c : result)
+    {
+        unsigned letter = static_cast<unsigned char>(c - 'a');
+        if(letter < 26)
+        {
+            c = keys.at(position % keys.size()).at(letter);
+            ++position;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief run_kernel Substitutes text with a kernel, starting at a given
+ * offset of the buffers, either into another buffer or in place
+ * @return the output, or a string with an error mark if the kernel wrote
+ * past the output or returned a wrong length
+ */
+template <typename Substitute>
+string run_kernel(const string& text, size_t offset, bool in_place, Substitute substitute)
+{
+    vector<char> in(offset + text.size() + GUARD_BYTES, GUARD);
+    vector<char> out(offset + text.size() + GUARD_BYTES, GUARD);
+    copy(text.begin(), text.end(), in.begin() + offset);
+    char* source = in.data() + offset;
+    char* target = in_place ? source : out.data() + offset;
+
+    size_t written = substitute(source, text.size(), target);
+    if(written > text.size())
+    {
+        return "kernel returned too long a length";
+    }
+    const vector<char>& buffer = in_place ? in : out;
+    for(size_t i = offset + text.size(); i < buffer.size(); ++i)
+    {
+        if(buffer.at(i) != GUARD)
+        {
+            return "kernel wrote past the input";
+        }
+    }
+    return string(target, written);
+}
+
+void test_single_key_kernels(Substitution_kernel kernel, mt19937& rng)
+{
+    for(size_t length : test_lengths(rng))
+    {
+        const string key = random_key(rng);
+        const string text = random_text(rng, length);
+        const size_t offset = rng() % 64;
+        const bool in_place = rng() % 2 == 0;
+
+        Substitution_tables dropping;
+        compile_substitution(dropping, key.data(), key.length());
+        CHECK(run_kernel(text, offset, in_place, [&](const char* in, size_t n, char* out)
+        {
+            return substitute(kernel, dropping, in, n, out);
+        }) == encrypt(text, key));
+
+        Substitution_tables passing;
+        compile_substitution(passing, key.data(), key.length(), true);
+        CHECK(run_kernel(text, offset, in_place, [&](const char* in, size_t n, char* out)
+        {
+            return substitute(kernel, passing, in, n, out);
+        }) == pass_through(text, {key}, 0));
+    }
+}
+
+void test_key_sequence_kernels(Substitution_kernel kernel, mt19937& rng)
+{
+    for(size_t length : test_lengths(rng))
+    {
+        // Up to 130 keys, past the most any vector kernel takes.
+        vector<string> keys(1 + rng() % 130);
+        for(string& key : keys)
+        {
+            key = random_key(rng);
+        }
+        const string text = random_text(rng, length);
+        const size_t position = rng() % 1000;
+        const size_t offset = rng() % 64;
+        const bool in_place = rng() % 2 == 0;
+
+        // encrypt_with_keys starts from the first key, so the reference
+        // gets the keys rotated to the one of the given position.
+        vector<string> rotated(keys.size());
+        for(size_t k = 0; k < keys.size(); ++k)
+        {
+            rotated.at(k) = keys.at((position + k) % keys.size());
+        }
+
+        Key_sequence_tables dropping;
+        compile_key_sequence(dropping, keys);
+        CHECK(run_kernel(text, offset, in_place, [&](const char* in, size_t n, char* out)
+        {
+            return substitute(kernel, dropping, position, in, n, out);
+        }) == encrypt_with_keys(text, rotated));
+
+        Key_sequence_tables passing;
+        compile_key_sequence(passing, keys, true);
+        CHECK(run_kernel(text, offset, in_place, [&](const char* in, size_t n, char* out)
+        {
+            return substitute(kernel, passing, position, in, n, out);
+        }) == pass_through(text, keys, position));
+    }
+}
+
+}
+
+int main()
+{
+    for(Substitution_kernel kernel : KERNELS)
+    {
+        if(not kernel_supported(kernel))
+        {
+            cout << "Skipping the " << substitution_kernel_name(kernel)
+                 << " kernel, which this CPU does not support" << endl;
+            continue;
+        }
+        cout << "Testing the " << substitution_kernel_name(kernel) << " kernel" << endl;
+        for(unsigned seed = 1; seed <= 20; ++seed)
+        {
+            mt19937 rng(seed);
+            test_single_key_kernels(kernel, rng);
+            test_key_sequence_kernels(kernel, rng);
+        }
+    }
+
+    return test_result();
+}
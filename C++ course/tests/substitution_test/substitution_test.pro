@@ -0,0 +1,13 @@
+TEMPLATE = app
+CONFIG += console c++14 thread testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../harness ../../encryption
+
+SOURCES += main.cpp \
+    ../../encryption/encryption.cpp \
+    ../../encryption/substitution.cpp
+
+HEADERS += \
+    ../harness/test.hh
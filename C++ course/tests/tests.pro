@@ -0,0 +1,10 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    cards_test \
+    cipher_test \
+    concurrent_cards_test \
+    fixed_cipher_test \
+    molkky_test \
+    stream_test \
+    substitution_test